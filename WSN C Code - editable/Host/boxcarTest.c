@@ -0,0 +1,264 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Checks the moving averages of @e boxcar.h: parameter checks, rounding of
+ * halves away from zero, that lengths that are powers of two give the same
+ * averages as those that are not, start-up before the filter is full, and the
+ * phase of decimated outputs. The exit status is non-zero if any check fails.
+ *
+ * Usage: @code boxcarTest @endcode
+ *
+ * @file boxcarTest.c
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "global.h"
+#include "boxcar.h"
+
+
+/* Channels in each sweep. */
+#define CHANNELS        3
+
+/* Sweeps added in each random check. */
+#define RANDOM_SWEEPS   5000
+
+/* Output value that the filter never writes in these checks. */
+#define UNTOUCHED       0x5A5A
+
+
+static boxcar_filterType filter;
+static int16_t history[BOXCAR_MAX_LENGTH * CHANNELS];
+static int32_t sums[CHANNELS];
+
+
+/*------------------------------------------------------------------------------
+ * The average of count inputs summing to sum, scaled by 2^fractionBits and
+ * rounded to the nearest, halves away from zero.
+ */
+static int16_t reference(int32_t sum, unsigned count, unsigned fractionBits)
+{
+    sum *= 1L << fractionBits;
+    if (sum >= 0) {
+        return (int16_t)((sum + (int32_t)count / 2) / (int32_t)count);
+    }
+    return (int16_t)-((-sum + (int32_t)count / 2) / (int32_t)count);
+}
+
+
+/*------------------------------------------------------------------------------
+ * Check that init rejects parameters out of range. Returns the number of
+ * failures.
+ */
+static unsigned checkInit(void)
+{
+    static const struct {
+        uint8_t channels, length, decimation, fractionBits;
+        status_t status;
+    } cases[] = {
+        {0, 4, 1, 0, STATUS_INVALID_ARG},
+        {1, 0, 1, 0, STATUS_INVALID_ARG},
+        {1, BOXCAR_MAX_LENGTH + 1, 1, 0, STATUS_INVALID_ARG},
+        {1, 4, 0, 0, STATUS_INVALID_ARG},
+        {1, 4, 1, BOXCAR_MAX_FRACTION + 1, STATUS_INVALID_ARG},
+        {1, 1, 1, 0, STATUS_OK},
+        {CHANNELS, BOXCAR_MAX_LENGTH, 255, BOXCAR_MAX_FRACTION, STATUS_OK},
+    };
+    unsigned i, failures = 0;
+    status_t status;
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        status = boxcar_init(&filter, history, sums, cases[i].channels,
+                cases[i].length, cases[i].decimation, cases[i].fractionBits);
+        if (status != cases[i].status) {
+            printf("init %u/%u/%u/%u: status %d, not %d\n",
+                    cases[i].channels, cases[i].length, cases[i].decimation,
+                    cases[i].fractionBits, status, cases[i].status);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+
+/*------------------------------------------------------------------------------
+ * Check the rounding of averages that fall on or near a half, with a length
+ * that is a power of two and one that is not. Returns the number of failures.
+ */
+static unsigned checkRounding(void)
+{
+    static const struct {
+        uint8_t length;
+        int16_t inputs[3];
+        int16_t average;
+    } cases[] = {
+        {2, {0, 1}, 1},         /* 0.5 */
+        {2, {0, -1}, -1},       /* -0.5 */
+        {2, {1, 2}, 2},         /* 1.5 */
+        {2, {-1, -2}, -2},      /* -1.5 */
+        {2, {3, -4}, -1},       /* -0.5 */
+        {3, {1, 1, 2}, 1},      /* 4/3 */
+        {3, {1, 2, 2}, 2},      /* 5/3 */
+        {3, {-1, -1, -2}, -1},  /* -4/3 */
+        {3, {-1, -2, -2}, -2},  /* -5/3 */
+    };
+    unsigned i, n, failures = 0;
+    int16_t output = 0;
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        boxcar_init(&filter, history, sums, 1, cases[i].length, 1, 0);
+        for (n = 0; n < cases[i].length; ++n) {
+            boxcar_add(&filter, &cases[i].inputs[n], &output);
+        }
+        if (output != cases[i].average) {
+            printf("length %u, case %u: average %d, not %d\n",
+                    cases[i].length, i, output, cases[i].average);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+
+/*------------------------------------------------------------------------------
+ * Filter random inputs, from the first sweep on, and check every output
+ * against the reference average. Returns the number of failures.
+ */
+static unsigned checkRandom(uint8_t length, uint8_t fractionBits)
+{
+    int16_t inputs[RANDOM_SWEEPS][CHANNELS];
+    int16_t output[CHANNELS];
+    int16_t expected;
+    int32_t sum;
+    unsigned n, k, c, count, failures = 0;
+    /* Keep the scaled averages within an int16_t */
+    int range = 32000 >> fractionBits;
+
+    srand(length * 16 + fractionBits);
+    boxcar_init(&filter, history, sums, CHANNELS, length, 1, fractionBits);
+    for (n = 0; n < RANDOM_SWEEPS; ++n) {
+        for (c = 0; c < CHANNELS; ++c) {
+            inputs[n][c] = (int16_t)(rand() % (2 * range + 1) - range);
+        }
+        if (!boxcar_add(&filter, inputs[n], output)) {
+            printf("length %u: no output at sweep %u\n", length, n);
+            return failures + 1;
+        }
+
+        count = (n + 1 < length) ? n + 1 : length;
+        for (c = 0; c < CHANNELS; ++c) {
+            sum = 0;
+            for (k = n + 1 - count; k <= n; ++k) {
+                sum += inputs[k][c];
+            }
+            expected = reference(sum, count, fractionBits);
+            if (output[c] != expected) {
+                printf("length %u, fraction %u, sweep %u: %d, not %d\n",
+                        length, fractionBits, n, output[c], expected);
+                return failures + 1;
+            }
+        }
+    }
+    return failures;
+}
+
+
+/*------------------------------------------------------------------------------
+ * Check that a decimated filter gives an output on every decimation-th input
+ * and leaves the output alone otherwise, and that the output may be the input.
+ * Returns the number of failures.
+ */
+static unsigned checkDecimation(void)
+{
+    int16_t output[CHANNELS];
+    int16_t sweep[CHANNELS];
+    unsigned n, c, failures = 0;
+    bool isOutput;
+
+    boxcar_init(&filter, history, sums, CHANNELS, 4, 3, 0);
+    for (n = 0; n < 12; ++n) {
+        for (c = 0; c < CHANNELS; ++c) {
+            output[c] = UNTOUCHED;
+        }
+        sweep[0] = (int16_t)(4 * n);
+        sweep[1] = (int16_t)(-4 * n);
+        sweep[2] = 7;
+        isOutput = boxcar_add(&filter, sweep, output);
+
+        if (isOutput != (n % 3 == 2)) {
+            printf("decimation 3, input %u: output %d\n", n, isOutput);
+            failures++;
+        } else if (!isOutput && (output[0] != UNTOUCHED ||
+                output[1] != UNTOUCHED || output[2] != UNTOUCHED)) {
+            printf("decimation 3, input %u: output written\n", n);
+            failures++;
+        } else if (isOutput) {
+            /* Mean of 4n and the inputs before it, up to 4 of them */
+            int16_t mean = (int16_t)((n < 3) ? 2 * n : 4 * n - 6);
+            if (output[0] != mean || output[1] != -mean || output[2] != 7) {
+                printf("decimation 3, input %u: %d %d %d, not %d %d 7\n", n,
+                        output[0], output[1], output[2], mean, -mean);
+                failures++;
+            }
+        }
+    }
+
+    /* Filtered in place */
+    boxcar_init(&filter, history, sums, CHANNELS, 2, 1, 0);
+    for (n = 0; n < 2; ++n) {
+        sweep[0] = (int16_t)(10 * n);
+        sweep[1] = (int16_t)(-10 * n);
+        sweep[2] = 7;
+        boxcar_add(&filter, sweep, sweep);
+    }
+    if (sweep[0] != 5 || sweep[1] != -5 || sweep[2] != 7) {
+        printf("in place: %d %d %d, not 5 -5 7\n", sweep[0], sweep[1],
+                sweep[2]);
+        failures++;
+    }
+    return failures;
+}
+
+
+int main(void)
+{
+    static const uint8_t lengths[] = {1, 2, 3, 4, 6, 16, 31, BOXCAR_MAX_LENGTH};
+    unsigned i, failures;
+
+    failures = checkInit() + checkRounding() + checkDecimation();
+    for (i = 0; i < sizeof(lengths); ++i) {
+        failures += checkRandom(lengths[i], 0);
+        failures += checkRandom(lengths[i], BOXCAR_MAX_FRACTION);
+    }
+    printf("%u failures\n", failures);
+
+    return (failures == 0) ? 0 : 1;
+}
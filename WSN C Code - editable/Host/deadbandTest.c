@@ -0,0 +1,302 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Checks the deadband transmission of @e deadband.h: which sensors the sender
+ * picks, keyframes by sweep count and by time (across a wrap of the clock),
+ * how the receiver fills in the sensors that were not sent, and that a
+ * receiver following a sender never strays by more than the deadbands. The
+ * exit status is non-zero if any check fails.
+ *
+ * Usage: @code deadbandTest @endcode
+ *
+ * @file deadbandTest.c
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "global.h"
+#include "deadband.h"
+
+
+/* Values in a sweep of all sensors. */
+#define SWEEP_VALUES    (DEADBAND_CHANNELS * DEADBAND_VALUES_PER_CHANNEL)
+
+/* Sweeps sent from the sender to the receiver. */
+#define FOLLOW_SWEEPS   10000
+
+
+/* Deadband of each sensor: 2, but none for sensor 5 and 20 for sensor 15. */
+static const uint8_t deadbands[DEADBAND_CHANNELS] = {
+    2, 2, 2, 2, 2, 0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 20
+};
+
+
+/*------------------------------------------------------------------------------
+ * Check the mask chosen for a sweep. Returns the number of failures (0 or 1).
+ */
+static unsigned expectMask(deadband_stateType* state, const int16_t* values,
+        uint32_t time, uint16_t mask, const char* what)
+{
+    uint16_t selected = deadband_select(state, values, time);
+
+    if (selected != mask) {
+        printf("%s: mask 0x%04X, not 0x%04X\n", what, selected, mask);
+        return 1;
+    }
+    return 0;
+}
+
+
+/*------------------------------------------------------------------------------
+ * Check which sensors are sent as they move. Returns the number of failures.
+ */
+static unsigned checkSelect(void)
+{
+    deadband_stateType state;
+    int16_t values[SWEEP_VALUES] = {0};
+    unsigned failures = 0;
+
+    deadband_init(&state, deadbands, 0, 0);
+    failures += expectMask(&state, values, 0, DEADBAND_ALL_CHANNELS,
+            "first sweep");
+    failures += expectMask(&state, values, 0, 0, "sweep with no change");
+
+    /* Sensor 3 moves by its deadband, then past it */
+    values[9] = 2;
+    failures += expectMask(&state, values, 0, 0, "change of the deadband");
+    values[9] = 3;
+    failures += expectMask(&state, values, 0, 0x0008, "change past it");
+
+    /* Changes are measured from the value last sent, not the last sweep */
+    values[9] = 5;
+    failures += expectMask(&state, values, 0, 0, "change from the last sent");
+    values[9] = 6;
+    failures += expectMask(&state, values, 0, 0x0008, "drift past it");
+
+    /* Any one value of a sensor, either way */
+    values[11] = -3;
+    values[13] = -2;
+    failures += expectMask(&state, values, 0, 0x0008, "third value of 3");
+    failures += expectMask(&state, values, 0, 0, "sensor 4 still inside");
+    values[13] = -3;
+    failures += expectMask(&state, values, 0, 0x0010,
+            "negative change past it");
+
+    /* No deadband sends every change, and a wide one none of these */
+    values[15] = 1;
+    values[45] = 20;
+    values[47] = -20;
+    failures += expectMask(&state, values, 0, 0x0020,
+            "sensors 5 and 15");
+    values[46] = 21;
+    failures += expectMask(&state, values, 0, 0x8000, "sensor 15 past 20");
+
+    /* Full scale of the 10-bit converter, either way */
+    values[0] = 1023;
+    failures += expectMask(&state, values, 0, 0x0001, "full scale up");
+    values[0] = -1024;
+    failures += expectMask(&state, values, 0, 0x0001, "full scale down");
+
+    return failures;
+}
+
+
+/*------------------------------------------------------------------------------
+ * Check that keyframes come every keySweeps sweeps or keyTicks ticks,
+ * whichever is first. Returns the number of failures.
+ */
+static unsigned checkKeyframes(void)
+{
+    deadband_stateType state;
+    int16_t values[SWEEP_VALUES] = {0};
+    unsigned n, failures = 0;
+    uint32_t time;
+    char what[64];
+
+    /* Every 4 sweeps, whether or not anything was sent in between */
+    deadband_init(&state, deadbands, 4, 0);
+    for (n = 0; n < 13; ++n) {
+        values[0] = (n == 5) ? 10 : 0;
+        sprintf(what, "sweep %u of keySweeps 4", n);
+        failures += expectMask(&state, values, 1000000UL * n,
+                (n % 4 == 0) ? DEADBAND_ALL_CHANNELS :
+                (n == 5 || n == 6) ? 0x0001 : 0, what);
+    }
+
+    /* Every 1000 ticks, from the time of the last keyframe, across a wrap */
+    time = 0xFFFFFC00UL;
+    deadband_init(&state, deadbands, 0, 1000);
+    failures += expectMask(&state, values, time, DEADBAND_ALL_CHANNELS,
+            "first sweep of keyTicks 1000");
+    failures += expectMask(&state, values, time + 999, 0,
+            "999 ticks after the keyframe");
+    failures += expectMask(&state, values, time + 1000, DEADBAND_ALL_CHANNELS,
+            "1000 ticks after the keyframe");
+    failures += expectMask(&state, values, time + 1999, 0,
+            "999 ticks after a wrap");
+    failures += expectMask(&state, values, time + 2500, DEADBAND_ALL_CHANNELS,
+            "1500 ticks after the keyframe");
+    failures += expectMask(&state, values, time + 3499, 0,
+            "keyframe times do not stay on a grid");
+
+    /* Whichever comes first */
+    deadband_init(&state, deadbands, 3, 1000);
+    failures += expectMask(&state, values, 0, DEADBAND_ALL_CHANNELS,
+            "first sweep of both");
+    failures += expectMask(&state, values, 1000, DEADBAND_ALL_CHANNELS,
+            "keyframe by time");
+    failures += expectMask(&state, values, 1001, 0, "after keyframe by time");
+    failures += expectMask(&state, values, 1002, 0, "second after it");
+    failures += expectMask(&state, values, 1003, DEADBAND_ALL_CHANNELS,
+            "keyframe by sweeps");
+
+    /* Neither: only the first sweep */
+    deadband_init(&state, deadbands, 0, 0);
+    failures += expectMask(&state, values, 0, DEADBAND_ALL_CHANNELS,
+            "first sweep of neither");
+    for (n = 1; n < 70000; ++n) {
+        if (deadband_select(&state, values, n * 100000UL) != 0) {
+            printf("keyframe at sweep %u without keySweeps or keyTicks\n", n);
+            failures++;
+            break;
+        }
+    }
+    return failures;
+}
+
+
+/*------------------------------------------------------------------------------
+ * Check how the receiver rebuilds sweeps. Returns the number of failures.
+ */
+static unsigned checkReceive(void)
+{
+    deadband_stateType state;
+    int16_t values[SWEEP_VALUES];
+    int16_t expected[SWEEP_VALUES];
+    unsigned i, failures = 0;
+
+    deadband_init(&state, NULL, 0, 0);
+    for (i = 0; i < SWEEP_VALUES; ++i) {
+        expected[i] = (int16_t)(1000 - 50 * i);
+    }
+    memcpy(values, expected, sizeof(values));
+    deadband_receive(&state, DEADBAND_ALL_CHANNELS, values);
+    if (memcmp(values, expected, sizeof(values)) != 0) {
+        printf("keyframe was changed\n");
+        failures++;
+    }
+
+    /* Sensors 0, 3 and 15, packed lowest first */
+    for (i = 0; i < 9; ++i) {
+        values[i] = (int16_t)(-1 - i);
+    }
+    for (i = 0; i < 3; ++i) {
+        expected[i] = (int16_t)(-1 - i);
+        expected[9 + i] = (int16_t)(-4 - i);
+        expected[45 + i] = (int16_t)(-7 - i);
+    }
+    deadband_receive(&state, 0x8009, values);
+    if (memcmp(values, expected, sizeof(values)) != 0) {
+        printf("sensors not sent were not filled in\n");
+        failures++;
+    }
+
+    /* Nothing sent gives the last sweep */
+    deadband_receive(&state, 0, values);
+    if (memcmp(values, expected, sizeof(values)) != 0) {
+        printf("empty sweep did not give the last one\n");
+        failures++;
+    }
+    return failures;
+}
+
+
+/*------------------------------------------------------------------------------
+ * Send random walks from a sender to a receiver, as the glove and base station
+ * do, and check that every value received is within its deadband, and exact
+ * for sensors that were sent. Returns the number of failures.
+ */
+static unsigned checkFollow(void)
+{
+    deadband_stateType sender, receiver;
+    int16_t values[SWEEP_VALUES] = {0};
+    int16_t frame[SWEEP_VALUES];
+    unsigned n, i, count, failures = 0;
+    unsigned long sent = 0;
+    uint16_t mask;
+    int error;
+
+    srand(1);
+    deadband_init(&sender, deadbands, 50, 0);
+    deadband_init(&receiver, NULL, 0, 0);
+    for (n = 0; n < FOLLOW_SWEEPS && failures == 0; ++n) {
+        for (i = 0; i < SWEEP_VALUES; ++i) {
+            values[i] = (int16_t)(values[i] + rand() % 3 - 1);
+        }
+        mask = deadband_select(&sender, values, n);
+
+        count = 0;
+        for (i = 0; i < SWEEP_VALUES; ++i) {
+            if (mask & (1U << (i / DEADBAND_VALUES_PER_CHANNEL))) {
+                frame[count++] = values[i];
+            }
+        }
+        sent += count;
+        deadband_receive(&receiver, mask, frame);
+
+        for (i = 0; i < SWEEP_VALUES; ++i) {
+            error = frame[i] - values[i];
+            if ((mask & (1U << (i / DEADBAND_VALUES_PER_CHANNEL)) &&
+                    error != 0) ||
+                    abs(error) > deadbands[i / DEADBAND_VALUES_PER_CHANNEL]) {
+                printf("sweep %u: value %u is %d out\n", n, i, error);
+                failures++;
+                break;
+            }
+        }
+    }
+    printf("%lu of %lu values sent\n", sent,
+            (unsigned long)FOLLOW_SWEEPS * SWEEP_VALUES);
+    return failures;
+}
+
+
+int main(void)
+{
+    unsigned failures;
+
+    failures = checkSelect() + checkKeyframes() + checkReceive() +
+            checkFollow();
+    printf("%u failures\n", failures);
+
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,192 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Compares the fixed-point sensor conversions (see @e fixedPoint.h) with the
+ * floating point ones they replace in the glove and base station, and
+ * measures how fast each is on the PC. Every ADXL345 reading and every 10-bit
+ * ADC reading is converted both ways, and the decimal text must read back as
+ * the same value, so a change that makes the nodes print different numbers is
+ * reported here. The exit status is non-zero if any check fails.
+ *
+ * Usage: @code fixedPointBench [rounds] @endcode
+ * The default is 1000 rounds over all readings.
+ *
+ * @file fixedPointBench.c
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "global.h"
+#include "fixedPoint.h"
+
+
+/* Range of ADXL345 full resolution readings (+-16g). */
+#define ACC_MIN         (-4096)
+#define ACC_MAX         4095
+
+/* ADC used for the bend sensors: 10 bits, 3.3V reference. */
+#define ADC_BITS        10
+#define ADC_REF_MV      3300
+
+/* Default number of rounds timed. */
+#define DEFAULT_ROUNDS  1000UL
+
+
+/*------------------------------------------------------------------------------
+ * Check that text is a number within tolerance of expected. Returns 1 if not.
+ */
+static unsigned checkText(const char* text, double expected, double tolerance,
+        const char* what, long input)
+{
+    char* end;
+    double value = strtod(text, &end);
+
+    if (*end != '\0' || fabs(value - expected) > tolerance) {
+        printf("%s %ld: \"%s\", expected %.6f\n", what, input, text, expected);
+        return 1;
+    }
+    return 0;
+}
+
+
+/*------------------------------------------------------------------------------
+ * Check every accelerometer and ADC reading against the double maths used
+ * before. Returns the number of failures.
+ */
+static unsigned checkConversions(void)
+{
+    char text[FIXEDPOINT_FORMAT_SIZE];
+    unsigned failures = 0;
+    long raw;
+
+    for (raw = ACC_MIN; raw <= ACC_MAX; ++raw) {
+        /* Rounded to the nearest milli-g */
+        fixedPoint_format(text, fixedPoint_accToMilliG((int16_t)raw), 3);
+        failures += checkText(text, raw * (1.0 / 256), 0.0005 + 1e-9,
+                "acc", raw);
+    }
+    for (raw = 0; raw < (1 << ADC_BITS); ++raw) {
+        fixedPoint_format(text, fixedPoint_adcToMilliVolts((uint16_t)raw,
+                ADC_REF_MV, ADC_BITS), 3);
+        failures += checkText(text, raw * (3.3 / 1024), 0.0005 + 1e-9,
+                "adc", raw);
+    }
+    return failures;
+}
+
+
+/*------------------------------------------------------------------------------
+ * Check the decimal text of some awkward values. Returns the number of
+ * failures.
+ */
+static unsigned checkFormat(void)
+{
+    static const struct {
+        int32_t value;
+        uint8_t decimals;
+        const char* text;
+    } cases[] = {
+        {0, 0, "0"}, {0, 3, "0.000"}, {7, 3, "0.007"}, {-31, 3, "-0.031"},
+        {1650, 3, "1.650"}, {-1000, 3, "-1.000"}, {123456789, 6, "123.456789"},
+        {INT32_MAX, 0, "2147483647"}, {INT32_MIN, 0, "-2147483648"},
+        {5, 9, "0.000000005"}, {-5, 1, "-0.5"}
+    };
+    char text[FIXEDPOINT_FORMAT_SIZE];
+    unsigned failures = 0;
+    unsigned i;
+    uint8_t length;
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        length = fixedPoint_format(text, cases[i].value, cases[i].decimals);
+        if (strcmp(text, cases[i].text) != 0 || text[length] != '\0') {
+            printf("format %ld (%u decimals): \"%s\", expected \"%s\"\n",
+                    (long)cases[i].value, cases[i].decimals, text,
+                    cases[i].text);
+            failures++;
+        }
+    }
+    if (fixedPoint_round(-0x180, 8) != -2 || fixedPoint_round(0x17F, 8) != 1 ||
+            fixedPoint_mul(FIXEDPOINT_FROM_INT(3, 8), 0x80, 8) != 0x180) {
+        printf("Q format rounding differs\n");
+        failures++;
+    }
+    return failures;
+}
+
+
+int main(int argc, char* argv[])
+{
+    char text[FIXEDPOINT_FORMAT_SIZE];
+    unsigned long rounds = DEFAULT_ROUNDS;
+    unsigned long n, count, checksum = 0;
+    unsigned failures;
+    long raw;
+    clock_t start;
+    double floatTime, fixedTime;
+
+    if (argc > 1) {
+        rounds = strtoul(argv[1], NULL, 0);
+    }
+
+    failures = checkConversions() + checkFormat();
+
+    /* Same work as the nodes: scale an accelerometer reading and print it */
+    start = clock();
+    for (n = 0; n < rounds; ++n) {
+        for (raw = ACC_MIN; raw <= ACC_MAX; ++raw) {
+            snprintf(text, sizeof(text), "%.3f", raw * (1.0 / 256));
+            checksum += (unsigned char)text[1];
+        }
+    }
+    floatTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (n = 0; n < rounds; ++n) {
+        for (raw = ACC_MIN; raw <= ACC_MAX; ++raw) {
+            fixedPoint_format(text, fixedPoint_accToMilliG((int16_t)raw), 3);
+            checksum += (unsigned char)text[1];
+        }
+    }
+    fixedTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    count = rounds * (ACC_MAX - ACC_MIN + 1);
+    printf("%lu readings (checksum %lu)\n", count, checksum);
+    if (count > 0 && floatTime > 0 && fixedTime > 0) {
+        printf("double + snprintf: %.1f ns/reading\n", 1e9 * floatTime / count);
+        printf("fixedPoint:        %.1f ns/reading\n", 1e9 * fixedTime / count);
+    }
+    printf("%u failures\n", failures);
+
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Implementation of the gesture file reader.
+ *
+ * @file gestureData.c
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "global.h"
+#include "gestureData.h"
+
+
+#define LINE_VALUES (GESTUREDATA_ACC_VALUES + GESTUREDATA_BEND_VALUES)
+
+
+/*------------------------------------------------------------------------------
+ * Turn a normalised value back into a raw reading.
+ */
+static int16_t toRaw(double normalised, double unitsPerLsb, int16_t min,
+        int16_t max)
+{
+    double raw = (normalised * 4.5 / 100 - 1.5) / unitsPerLsb;
+
+    raw = floor(raw + 0.5);
+    if (raw < min) {
+        return min;
+    }
+    if (raw > max) {
+        return max;
+    }
+    return (int16_t)raw;
+}
+
+
+/******************************************************************************\
+ * See gestureData.h for documentation of these functions.
+\******************************************************************************/
+
+unsigned long gestureData_load(const char* path, gestureData_sweepType** sweeps,
+        unsigned long count)
+{
+    char line[1024];
+    double values[LINE_VALUES];
+    FILE* file;
+    char* text;
+    char* end;
+    gestureData_sweepType* sweep;
+    int i;
+
+    if ((file = fopen(path, "r")) == NULL) {
+        perror(path);
+        exit(1);
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        text = line;
+        for (i = 0; i < LINE_VALUES; ++i) {
+            values[i] = strtod(text, &end);
+            if (end == text) {
+                break;
+            }
+            text = (*end == ',') ? end + 1 : end;
+        }
+        if (i != LINE_VALUES) {
+            continue;
+        }
+
+        *sweeps = realloc(*sweeps, (count + 1) * sizeof(gestureData_sweepType));
+        if (*sweeps == NULL) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+        sweep = &(*sweeps)[count++];
+        for (i = 0; i < GESTUREDATA_ACC_VALUES; ++i) {
+            sweep->acc[i] = toRaw(values[i], 1.0 / 256, -4096, 4095);
+        }
+        for (i = 0; i < GESTUREDATA_BEND_VALUES; ++i) {
+            sweep->bend[i] = toRaw(values[GESTUREDATA_ACC_VALUES + i],
+                    3.3 / 1024, 0, 1023);
+        }
+    }
+    fclose(file);
+    return count;
+}
@@ -0,0 +1,78 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Reading of the gesture @e .dat files recorded by the PC application, for the
+ * host tools.
+ *
+ * Each line of a gesture file holds 48 accelerometer values followed by 6 bend
+ * sensor values, normalised by the PC application as
+ * 100 * (value + 1.5) / 4.5. The values are turned back into the raw readings
+ * sent by the glove: 1/256 g for the accelerometers and 3.3/1024 V for the bend
+ * sensors.
+ *
+ * Note the recorded values have already been through the PC's 5-sample moving
+ * average.
+ *
+ * @file gestureData.h
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+
+#ifndef GESTUREDATA_H
+#define GESTUREDATA_H
+
+
+/** Accelerometer values on each line. **/
+#define GESTUREDATA_ACC_VALUES      48
+/** Bend sensor values on each line. **/
+#define GESTUREDATA_BEND_VALUES     6
+
+
+/** Raw readings of one recorded sweep. **/
+typedef struct {
+    int16_t acc[GESTUREDATA_ACC_VALUES];    /**< 1/256 g. **/
+    int16_t bend[GESTUREDATA_BEND_VALUES];  /**< 3.3/1024 V. **/
+} gestureData_sweepType;
+
+
+/**
+ * Add the sweeps in a gesture file to an array. Lines without the right number
+ * of values are skipped. The program exits if the file cannot be read.
+ *
+ * @param path file to read.
+ * @param[in,out] sweeps array of sweeps, grown with realloc(). Start with NULL.
+ * @param count number of sweeps already in the array.
+ *
+ * @return new number of sweeps in the array.
+ **/
+unsigned long gestureData_load(const char* path, gestureData_sweepType** sweeps,
+        unsigned long count);
+
+
+#endif
@@ -0,0 +1,237 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Builds the gesture centroids compiled into the glove (see @e gesture.h) from
+ * the PC application's training files, and writes them as a C header.
+ *
+ * The gesture names are read from @e GestureTypes.dat, and the training data of
+ * each from @e name.dat in the same directory (see gestureData.h). The centroid
+ * of a gesture is the average of its accelerometer readings, shifted right by
+ * the chosen number of bits. The training sweeps are then classified again
+ * with the integer classifier, and the share recognised correctly is printed.
+ *
+ * Usage:
+ * @code gestureExport [-s shift] [-o output.h] GestureData/GestureTypes.dat @endcode
+ * The default shift is 5 and the default output is standard output.
+ *
+ * @file gestureExport.c
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "global.h"
+#include "gesture.h"
+#include "gestureData.h"
+
+
+#define VALUES          GESTUREDATA_ACC_VALUES
+#define DEFAULT_SHIFT   5
+#define MAX_NAME        64
+
+
+static char names[GESTURE_MAX_GESTURES][MAX_NAME];
+static int8_t centroids[GESTURE_MAX_GESTURES * VALUES];
+static gestureData_sweepType* sweeps[GESTURE_MAX_GESTURES];
+static unsigned long sweepCounts[GESTURE_MAX_GESTURES];
+
+
+/*------------------------------------------------------------------------------
+ * Read the gesture names, and the training data of each. Returns the number of
+ * gestures.
+ */
+static uint8_t loadGestures(const char* typesPath)
+{
+    char path[1024];
+    char line[MAX_NAME];
+    const char* slash;
+    size_t directoryLength;
+    uint8_t count = 0;
+    FILE* file;
+
+    slash = strrchr(typesPath, '/');
+    if (slash == NULL) {
+        slash = strrchr(typesPath, '\\');
+    }
+    directoryLength = (slash == NULL) ? 0 : (size_t)(slash - typesPath + 1);
+
+    if ((file = fopen(typesPath, "r")) == NULL) {
+        perror(typesPath);
+        exit(1);
+    }
+    while (fgets(line, sizeof(line), file) != NULL) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0') {
+            continue;
+        }
+        if (count == GESTURE_MAX_GESTURES) {
+            fprintf(stderr, "more than %u gestures\n", GESTURE_MAX_GESTURES);
+            exit(1);
+        }
+        strcpy(names[count], line);
+        snprintf(path, sizeof(path), "%.*s%s.dat", (int)directoryLength,
+                typesPath, line);
+        sweepCounts[count] = gestureData_load(path, &sweeps[count], 0);
+        if (sweepCounts[count] == 0) {
+            fprintf(stderr, "%s: no sweeps found\n", path);
+            exit(1);
+        }
+        count++;
+    }
+    fclose(file);
+    return count;
+}
+
+
+/*------------------------------------------------------------------------------
+ * Work out the centroid of each gesture.
+ */
+static void makeCentroids(uint8_t count, uint8_t shift)
+{
+    double sum, average;
+    unsigned long n;
+    uint8_t g, i;
+
+    for (g = 0; g < count; ++g) {
+        for (i = 0; i < VALUES; ++i) {
+            sum = 0;
+            for (n = 0; n < sweepCounts[g]; ++n) {
+                sum += sweeps[g][n].acc[i];
+            }
+            average = sum / sweepCounts[g] / (1 << shift);
+            average += (average < 0) ? -0.5 : 0.5;
+            if (average < INT8_MIN) {
+                average = INT8_MIN;
+            } else if (average > INT8_MAX) {
+                average = INT8_MAX;
+            }
+            centroids[g * VALUES + i] = (int8_t)average;
+        }
+    }
+}
+
+
+/*------------------------------------------------------------------------------
+ * Write the centroids as a C header.
+ */
+static void writeHeader(FILE* out, uint8_t count, uint8_t shift,
+        const char* typesPath)
+{
+    uint8_t g, i;
+
+    fprintf(out, "/* Gesture centroids for gesture.h, generated by "
+            "Host/gestureExport from\n * %s. Do not edit. */\n\n", typesPath);
+    fprintf(out, "#ifndef GESTUREMODEL_H\n#define GESTUREMODEL_H\n\n");
+    fprintf(out, "#define GESTURE_MODEL_COUNT   %u\n", count);
+    fprintf(out, "#define GESTURE_MODEL_VALUES  %u\n", VALUES);
+    fprintf(out, "#define GESTURE_MODEL_SHIFT   %u\n\n", shift);
+    fprintf(out, "/* Gesture numbers */\n");
+    for (g = 0; g < count; ++g) {
+        fprintf(out, "/*   %u %s */\n", g + 1, names[g]);
+    }
+    fprintf(out, "\nstatic const int8_t gestureCentroids[GESTURE_MODEL_COUNT * "
+            "GESTURE_MODEL_VALUES] GESTURE_FLASH = {\n");
+    for (g = 0; g < count; ++g) {
+        fprintf(out, "    /* %s */", names[g]);
+        for (i = 0; i < VALUES; ++i) {
+            fprintf(out, "%s%4d,", (i % 12 == 0) ? "\n    " : "",
+                    centroids[g * VALUES + i]);
+        }
+        fprintf(out, "\n");
+    }
+    fprintf(out, "};\n\n#endif\n");
+}
+
+
+/*------------------------------------------------------------------------------
+ * Classify the training data with the integer classifier and print the share
+ * of each gesture recognised correctly.
+ */
+static void checkModel(uint8_t count, uint8_t shift)
+{
+    gesture_modelType model = {centroids, count, VALUES, shift};
+    unsigned long n, correct;
+    uint8_t g;
+
+    for (g = 0; g < count; ++g) {
+        correct = 0;
+        for (n = 0; n < sweepCounts[g]; ++n) {
+            if (gesture_classify(&model, sweeps[g][n].acc) == g + 1) {
+                correct++;
+            }
+        }
+        fprintf(stderr, "%u %-12s %5lu sweeps, %5.1f%% recognised\n", g + 1,
+                names[g], sweepCounts[g], 100.0 * correct / sweepCounts[g]);
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+    const char* outPath = NULL;
+    unsigned shift = DEFAULT_SHIFT;
+    uint8_t count, g;
+    FILE* out = stdout;
+    int arg;
+
+    for (arg = 1; arg + 1 < argc && argv[arg][0] == '-'; arg += 2) {
+        if (strcmp(argv[arg], "-s") == 0) {
+            shift = (unsigned)strtoul(argv[arg + 1], NULL, 0);
+        } else if (strcmp(argv[arg], "-o") == 0) {
+            outPath = argv[arg + 1];
+        } else {
+            break;
+        }
+    }
+    if (arg + 1 != argc || shift > 8) {
+        fprintf(stderr, "usage: %s [-s shift] [-o output.h] GestureTypes.dat\n",
+                argv[0]);
+        return 2;
+    }
+
+    count = loadGestures(argv[arg]);
+    makeCentroids(count, (uint8_t)shift);
+    checkModel(count, (uint8_t)shift);
+
+    if (outPath != NULL && (out = fopen(outPath, "w")) == NULL) {
+        perror(outPath);
+        return 1;
+    }
+    writeHeader(out, count, (uint8_t)shift, argv[arg]);
+    if (out != stdout) {
+        fclose(out);
+    }
+
+    for (g = 0; g < count; ++g) {
+        free(sweeps[g]);
+    }
+    return 0;
+}
@@ -0,0 +1,545 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Measures how fast glove radio frames (see @e gloveFrame.h) are written and
+ * read on the PC. Before timing, a set of frames is read back and compared with
+ * the values written, and frames that are too short or of another version must
+ * be rejected. The bytes of each frame type are also compared with the layout
+ * in gloveFrame.h, and packed frames are checked at their limits, so a change
+ * that breaks either side, or both in the same way, is reported here before it
+ * reaches the nodes. The exit status is non-zero if any check fails.
+ *
+ * Usage: @code gloveFrameBench [frames] @endcode
+ * The default is 1000000 frames of each type.
+ *
+ * @file gloveFrameBench.c
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "global.h"
+#include "gloveFrame.h"
+
+
+/* Values in a frame holding all sensors. */
+#define FRAME_VALUES    (GLOVEFRAME_CHANNELS * GLOVEFRAME_VALUES_PER_CHANNEL)
+
+/* Number of different frames cycled through while measuring. */
+#define FRAME_SETS      64
+
+/* Default number of frames written and read. */
+#define DEFAULT_FRAMES  1000000UL
+
+/* Largest packet payload of the CC2420 (RF_MAX_PAYLOAD_SIZE). */
+#define MAX_PAYLOAD     115
+
+
+static int16_t values[FRAME_SETS][FRAME_VALUES];
+static uint16_t masks[FRAME_SETS];
+
+
+/*------------------------------------------------------------------------------
+ * Fill the frame sets with values in the ranges sent by the glove.
+ */
+static void makeFrames(void)
+{
+    unsigned set, i;
+
+    srand(1);
+    for (set = 0; set < FRAME_SETS; ++set) {
+        /* Mostly full frames, with some partial ones */
+        masks[set] = (set % 4 == 0) ? (uint16_t)rand() : GLOVEFRAME_ALL_CHANNELS;
+        for (i = 0; i < FRAME_VALUES; ++i) {
+            values[set][i] = (int16_t)((rand() % 1024) - 512);
+        }
+    }
+}
+
+
+/*------------------------------------------------------------------------------
+ * Report a failed check. Returns the number of failures (0 or 1).
+ */
+static unsigned expect(int isOk, const char* what)
+{
+    if (!isOk) {
+        printf("%s\n", what);
+        return 1;
+    }
+    return 0;
+}
+
+
+/*------------------------------------------------------------------------------
+ * Check the bytes of a frame against those expected. Returns the number of
+ * failures (0 or 1).
+ */
+static unsigned expectBytes(const uint8_t* frame, const uint8_t* bytes,
+        unsigned count, const char* what)
+{
+    unsigned i;
+
+    for (i = 0; i < count; ++i) {
+        if (frame[i] != bytes[i]) {
+            printf("%s: byte %u is 0x%02X, not 0x%02X\n", what, i, frame[i],
+                    bytes[i]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/*------------------------------------------------------------------------------
+ * Check the header and values of a frame against the layout in gloveFrame.h,
+ * and that gloveFrame_compact() moves the values of the sensors it keeps down
+ * in order. Returns the number of failures.
+ */
+static unsigned checkLayout(void)
+{
+    static const uint8_t header[GLOVEFRAME_HEADER_SIZE] = {
+        GLOVEFRAME_VERSION, GLOVEFRAME_TYPE_BEND, 0x9A,
+        0x78, 0x56, 0x34, 0x12, 0xCD, 0xAB, 0x01, 0x80
+    };
+    static const uint8_t sensors[] = {
+        0xFE, 0xFF, 0x01, 0x00, 0x00, 0x80,     /* Sensor 0 */
+        0xFF, 0x7F, 0x34, 0x12, 0x00, 0x00      /* Sensor 15 */
+    };
+    uint8_t frame[GLOVEFRAME_SIZE(GLOVEFRAME_CHANNELS)];
+    int16_t sweep[FRAME_VALUES] = {-2, 1, -32768, 0x7FFF, 0x1234, 0};
+    int16_t decoded[FRAME_VALUES];
+    gloveFrame_headerType fields;
+    unsigned i, failures = 0;
+    uint8_t size;
+
+    size = gloveFrame_encode(frame, GLOVEFRAME_TYPE_BEND, 0x9A, 0x12345678UL,
+            0xABCD, 0x8001, sweep);
+    failures += expect(size == GLOVEFRAME_HEADER_SIZE + sizeof(sensors),
+            "two sensor frame has the wrong size");
+    failures += expectBytes(frame, header, sizeof(header), "header");
+    failures += expectBytes(frame + GLOVEFRAME_HEADER_SIZE, sensors,
+            sizeof(sensors), "values");
+
+    /* Keep sensors 0, 2 and 15 of a full frame, then only sensor 2 of those
+     * (asking for sensor 1 as well, which is no longer there) */
+    for (i = 0; i < FRAME_VALUES; ++i) {
+        sweep[i] = (int16_t)(i * 100 - 2000);
+    }
+    gloveFrame_encode(frame, GLOVEFRAME_TYPE_ACC, 1, 2, 3,
+            GLOVEFRAME_ALL_CHANNELS, sweep);
+    size = gloveFrame_compact(frame, 0x8005);
+    if (expect(size == GLOVEFRAME_SIZE(3) &&
+            gloveFrame_decode(frame, size, &fields, decoded) == STATUS_OK &&
+            fields.channelMask == 0x8005 && fields.seq == 1 &&
+            fields.time == 2 && fields.span == 3,
+            "compacted frame has the wrong header")) {
+        return failures + 1;
+    }
+    for (i = 0; i < GLOVEFRAME_VALUES_PER_CHANNEL; ++i) {
+        failures += expect(decoded[i] == sweep[i] &&
+                decoded[3 + i] == sweep[6 + i] &&
+                decoded[6 + i] == sweep[45 + i],
+                "compacted frame has the wrong values");
+    }
+    size = gloveFrame_compact(frame, 0x0006);
+    failures += expect(size == GLOVEFRAME_SIZE(1) &&
+            gloveFrame_decode(frame, size, &fields, decoded) == STATUS_OK &&
+            fields.channelMask == 0x0004 && decoded[0] == sweep[6] &&
+            decoded[2] == sweep[8], "sensor not in the frame was kept");
+    size = gloveFrame_compact(frame, 0);
+    failures += expect(size == GLOVEFRAME_HEADER_SIZE &&
+            frame[9] == 0 && frame[10] == 0, "empty frame has sensors");
+
+    return failures;
+}
+
+
+/*------------------------------------------------------------------------------
+ * Check the layout of beacon frames, and that slots are found and bad beacons
+ * rejected. Returns the number of failures.
+ */
+static unsigned checkBeacon(void)
+{
+    static const uint16_t addresses[3] = {0x7979, 0x1234, 0xBEEF};
+    static const uint8_t bytes[GLOVEFRAME_BEACON_SIZE(3)] = {
+        GLOVEFRAME_VERSION, GLOVEFRAME_TYPE_BEACON, 7,
+        0x04, 0x03, 0x02, 0x01, 0x00, 0x00, 0x00, 0x00,
+        0x10, 0x27, 3, 0x79, 0x79, 0x34, 0x12, 0xEF, 0xBE
+    };
+    uint8_t frame[GLOVEFRAME_BEACON_SIZE(GLOVEFRAME_MAX_SLOTS + 1)] = {0};
+    uint16_t slotLength;
+    uint8_t slotCount, slot, size;
+    unsigned failures = 0;
+
+    size = gloveFrame_writeBeacon(frame, 7, 0x01020304UL, 10000, 3, addresses);
+    failures += expect(size == sizeof(bytes), "beacon has the wrong size");
+    failures += expectBytes(frame, bytes, sizeof(bytes), "beacon");
+
+    failures += expect(gloveFrame_readBeacon(frame, size, 0x1234, &slotLength,
+            &slotCount, &slot) == STATUS_OK && slotLength == 10000 &&
+            slotCount == 3 && slot == 1, "beacon slot was not found");
+    failures += expect(gloveFrame_readBeacon(frame, size, 0xBEEF, &slotLength,
+            &slotCount, &slot) == STATUS_OK && slot == 2,
+            "last beacon slot was not found");
+    failures += expect(gloveFrame_readBeacon(frame, size, 0x4321, &slotLength,
+            &slotCount, &slot) == STATUS_OK && slot == GLOVEFRAME_NO_SLOT,
+            "glove without a slot was given one");
+    failures += expect(gloveFrame_readBeacon(frame, size - 1, 0x7979,
+            &slotLength, &slotCount, &slot) != STATUS_OK,
+            "beacon without its last address was not rejected");
+
+    size = gloveFrame_writeBeacon(frame, 0, 0, 10000, 0, addresses);
+    failures += expect(size == GLOVEFRAME_BEACON_SIZE(0) &&
+            gloveFrame_readBeacon(frame, size, 0x7979, &slotLength,
+                    &slotCount, &slot) == STATUS_OK &&
+            slotCount == 0 && slot == GLOVEFRAME_NO_SLOT,
+            "beacon with no slots was not read");
+    failures += expect(gloveFrame_readBeacon(frame, size - 1, 0x7979,
+            &slotLength, &slotCount, &slot) != STATUS_OK,
+            "beacon without its slot count was not rejected");
+
+    /* More slots than a beacon can hold, even with the bytes for them */
+    frame[GLOVEFRAME_BEACON_OFFSET + 2] = GLOVEFRAME_MAX_SLOTS + 1;
+    failures += expect(gloveFrame_readBeacon(frame, sizeof(frame), 0x7979,
+            &slotLength, &slotCount, &slot) != STATUS_OK,
+            "beacon with too many slots was not rejected");
+
+    gloveFrame_writeGesture(frame, 0, 0, 1);
+    failures += expect(gloveFrame_readBeacon(frame, GLOVEFRAME_BEACON_SIZE(0),
+            0x7979, &slotLength, &slotCount, &slot) != STATUS_OK,
+            "gesture frame was read as a beacon");
+
+    return failures;
+}
+
+
+/*------------------------------------------------------------------------------
+ * Check the layout of settle frames, and the reading times given by
+ * gloveFrame_bendOffset(). Returns the number of failures.
+ */
+static unsigned checkSettle(void)
+{
+    uint8_t settle[FRAME_VALUES];
+    uint8_t frame[GLOVEFRAME_SETTLE_SIZE + 1];
+    gloveFrame_headerType fields;
+    unsigned i, failures = 0;
+    uint8_t size;
+
+    for (i = 0; i < FRAME_VALUES; ++i) {
+        settle[i] = (uint8_t)i;
+    }
+    size = gloveFrame_writeSettle(frame, 4, 0x100, settle);
+    failures += expect(size == GLOVEFRAME_HEADER_SIZE + FRAME_VALUES &&
+            frame[1] == GLOVEFRAME_TYPE_SETTLE && frame[2] == 4 &&
+            frame[4] == 0x01 && frame[9] == 0 && frame[10] == 0,
+            "settle frame has the wrong header");
+    failures += expectBytes(frame + GLOVEFRAME_SETTLE_OFFSET, settle,
+            FRAME_VALUES, "settle table");
+    failures += expect(gloveFrame_readHeader(frame, size, &fields) == STATUS_OK,
+            "settle frame was rejected");
+    failures += expect(gloveFrame_readHeader(frame, size - 1, &fields) !=
+            STATUS_OK, "short settle frame was not rejected");
+
+    /* With no settling every conversion is a reading, so the 45 before the
+     * last mux position are evenly spread over the span */
+    memset(settle, 0, sizeof(settle));
+    for (i = 0; i < FRAME_VALUES; ++i) {
+        if (gloveFrame_bendOffset(settle, (uint8_t)i, 4500) != 100 * i) {
+            printf("bend value %u without settling is at %u us\n", i,
+                    gloveFrame_bendOffset(settle, (uint8_t)i, 4500));
+            failures++;
+            break;
+        }
+    }
+
+    /* The glove's default: 5 settling conversions at each mux position, so 8
+     * conversions a position and 120 before the last */
+    for (i = 0; i < FRAME_VALUES; i += GLOVEFRAME_VALUES_PER_CHANNEL) {
+        settle[i] = 5;
+    }
+    failures += expect(gloveFrame_bendOffset(settle, 0, 12000) == 500 &&
+            gloveFrame_bendOffset(settle, 1, 12000) == 600 &&
+            gloveFrame_bendOffset(settle, 2, 12000) == 700 &&
+            gloveFrame_bendOffset(settle, 3, 12000) == 1300 &&
+            gloveFrame_bendOffset(settle, 45, 12000) == 12500 &&
+            gloveFrame_bendOffset(settle, 47, 12000) == 12700,
+            "bend values with settling are at the wrong times");
+
+    /* Settling on one channel only delays the readings from there on */
+    settle[4] = 10;
+    failures += expect(gloveFrame_bendOffset(settle, 3, 13000) == 1300 &&
+            gloveFrame_bendOffset(settle, 4, 13000) == 2400 &&
+            gloveFrame_bendOffset(settle, 5, 13000) == 2500,
+            "extra settling moves the wrong bend values");
+
+    return failures;
+}
+
+
+/*------------------------------------------------------------------------------
+ * Check the layout of packed frames, and that sweeps which don't fit are
+ * refused and sweeps cut short are rejected. Returns the number of failures.
+ */
+static unsigned checkPacked(void)
+{
+    static const uint8_t header[GLOVEFRAME_PACKED_SIZE] = {
+        GLOVEFRAME_VERSION, GLOVEFRAME_TYPE_PACKED, 3,
+        0xE8, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, GLOVEFRAME_TYPE_ACC
+    };
+    uint8_t frame[255];
+    uint8_t block[SWEEPCODEC_MAX_SIZE(FRAME_VALUES)];
+    uint8_t wide[SWEEPCODEC_MAX_SIZE(FRAME_VALUES)];
+    uint8_t sweepHeader[GLOVEFRAME_SWEEP_HEADER_SIZE] = {9, 0x2C, 0x01, 0xFA, 0};
+    sweepCodec_stateType encoder, decoder;
+    gloveFrame_headerType fields;
+    int16_t sweep[FRAME_VALUES];
+    int16_t decoded[FRAME_VALUES];
+    unsigned i, failures = 0;
+    uint8_t size, wideSize, length, offset;
+
+    for (i = 0; i < FRAME_VALUES; ++i) {
+        sweep[i] = (int16_t)((i % 2) ? -40000 / 3 : 20000);
+    }
+    sweepCodec_init(&encoder, FRAME_VALUES, 0);
+    wideSize = sweepCodec_encode(&encoder, sweep, wide);
+    for (i = 0; i < FRAME_VALUES; ++i) {
+        sweep[i] = (int16_t)(sweep[i] + (int16_t)(i % 5) - 2);
+    }
+    size = sweepCodec_encode(&encoder, sweep, block);
+
+    length = gloveFrame_writePacked(frame, GLOVEFRAME_TYPE_ACC, 3, 1000);
+    failures += expect(length == GLOVEFRAME_PACKED_SIZE,
+            "empty packed frame has the wrong size");
+    failures += expectBytes(frame, header, sizeof(header), "packed header");
+
+    /* A full width keyframe of every sensor does not fit in one packet */
+    failures += expect(wideSize == SWEEPCODEC_MAX_SIZE(FRAME_VALUES) &&
+            gloveFrame_addSweep(frame, length, MAX_PAYLOAD, 8, 1000, 250,
+                    wide, wideSize) == 0,
+            "sweep larger than a packet was added");
+    length = gloveFrame_addSweep(frame, length, sizeof(frame), 8, 1000, 250,
+            wide, wideSize);
+    failures += expect(length == GLOVEFRAME_PACKED_SIZE +
+            GLOVEFRAME_SWEEP_HEADER_SIZE + wideSize, "keyframe was not added");
+
+    /* The next sweep fits exactly, or not at all */
+    memset(frame + length, 0xA5, sizeof(frame) - length);
+    failures += expect(gloveFrame_addSweep(frame, length,
+            length + GLOVEFRAME_SWEEP_HEADER_SIZE + size - 1, 9, 1300, 250,
+            block, size) == 0 && frame[length] == 0xA5,
+            "sweep was added to a full frame");
+    failures += expect(gloveFrame_addSweep(frame, length, 255, 9, 1000 + 65536,
+            250, block, size) == 0 && frame[length] == 0xA5,
+            "sweep too late for the frame was added");
+    failures += expect(gloveFrame_addSweep(frame, length, 255, 9, 999,
+            250, block, size) == 0 && frame[length] == 0xA5,
+            "sweep before the frame was added");
+    failures += expect(gloveFrame_addSweep(frame, length, 255, 10,
+            1000 + 65535, 0, block, size) != 0,
+            "last time a frame can hold was refused");
+    offset = length;
+    length = gloveFrame_addSweep(frame, length,
+            length + GLOVEFRAME_SWEEP_HEADER_SIZE + size, 9, 1300, 250,
+            block, size);
+    if (expect(length == offset + GLOVEFRAME_SWEEP_HEADER_SIZE + size,
+            "sweep that fits exactly was not added")) {
+        return failures + 1;
+    }
+    failures += expectBytes(frame + offset, sweepHeader, sizeof(sweepHeader),
+            "sweep header");
+    failures += expectBytes(frame + offset + GLOVEFRAME_SWEEP_HEADER_SIZE,
+            block, size, "sweep block");
+
+    /* Read both sweeps back */
+    sweepCodec_init(&decoder, FRAME_VALUES, 0);
+    failures += expect(gloveFrame_readHeader(frame, length, &fields) ==
+            STATUS_OK, "packed frame was rejected");
+    offset = GLOVEFRAME_PACKED_SIZE;
+    failures += expect(gloveFrame_readSweep(frame, length, &offset, &decoder,
+            &fields, decoded) == STATUS_OK && fields.seq == 8 &&
+            fields.time == 1000 && offset == length - size -
+            GLOVEFRAME_SWEEP_HEADER_SIZE, "keyframe was not read");
+    failures += expect(gloveFrame_readSweep(frame, length, &offset, &decoder,
+            &fields, decoded) == STATUS_OK && offset == length &&
+            fields.type == GLOVEFRAME_TYPE_ACC && fields.seq == 9 &&
+            fields.time == 1300 && fields.span == 250 &&
+            fields.channelMask == GLOVEFRAME_ALL_CHANNELS &&
+            memcmp(decoded, sweep, sizeof(sweep)) == 0,
+            "packed sweep was not read back");
+    failures += expect(gloveFrame_readSweep(frame, length, &offset, &decoder,
+            &fields, decoded) == STATUS_INVALID_ARG && offset == length,
+            "read past the end of a packed frame");
+
+    /* Cut short in the block and in the sweep header */
+    offset = length - size - GLOVEFRAME_SWEEP_HEADER_SIZE;
+    failures += expect(gloveFrame_readSweep(frame, length - 1, &offset,
+            &decoder, &fields, decoded) == STATUS_INVALID_ARG &&
+            offset == length - size - GLOVEFRAME_SWEEP_HEADER_SIZE,
+            "sweep without its last byte was not rejected");
+    failures += expect(gloveFrame_readSweep(frame, offset +
+            GLOVEFRAME_SWEEP_HEADER_SIZE - 1, &offset, &decoder, &fields,
+            decoded) == STATUS_INVALID_ARG,
+            "sweep without its header was not rejected");
+
+    /* A sweep needing a lost keyframe is skipped, but not the rest */
+    sweepCodec_init(&decoder, FRAME_VALUES, 0);
+    failures += expect(gloveFrame_readSweep(frame, length, &offset, &decoder,
+            &fields, decoded) == STATUS_COMM_ERROR && offset == length,
+            "sweep without its keyframe was not skipped");
+
+    return failures;
+}
+
+
+/*------------------------------------------------------------------------------
+ * Check that frames which must be rejected are. Returns the number of failures.
+ */
+static unsigned checkRejects(void)
+{
+    uint8_t frame[GLOVEFRAME_SIZE(GLOVEFRAME_CHANNELS)];
+    gloveFrame_headerType header;
+    int16_t decoded[FRAME_VALUES];
+    uint8_t size;
+    unsigned failures = 0;
+
+    size = gloveFrame_encode(frame, GLOVEFRAME_TYPE_ACC, 0, 0, 0,
+            GLOVEFRAME_ALL_CHANNELS, values[0]);
+
+    if (gloveFrame_decode(frame, size - 1, &header, decoded) == STATUS_OK) {
+        printf("short frame was not rejected\n");
+        failures++;
+    }
+    if (gloveFrame_decode(frame, GLOVEFRAME_HEADER_SIZE - 1, &header,
+            decoded) == STATUS_OK) {
+        printf("short header was not rejected\n");
+        failures++;
+    }
+    frame[0] = GLOVEFRAME_VERSION + 1;
+    if (gloveFrame_decode(frame, size, &header, decoded) == STATUS_OK) {
+        printf("wrong version was not rejected\n");
+        failures++;
+    }
+    return failures;
+}
+
+
+/*------------------------------------------------------------------------------
+ * Check that every frame set reads back as written. Returns the number of
+ * failures.
+ */
+static unsigned checkRoundTrip(void)
+{
+    uint8_t frame[GLOVEFRAME_SIZE(GLOVEFRAME_CHANNELS)];
+    gloveFrame_headerType header;
+    int16_t decoded[FRAME_VALUES];
+    unsigned set, count, i, failures = 0;
+    uint8_t type, size;
+
+    for (set = 0; set < FRAME_SETS; ++set) {
+        type = (set & 1) ? GLOVEFRAME_TYPE_BEND : GLOVEFRAME_TYPE_ACC;
+        size = gloveFrame_encode(frame, type, (uint8_t)set, 0x10000UL * set,
+                (uint16_t)(100 * set), masks[set], values[set]);
+
+        if (size != GLOVEFRAME_SIZE(gloveFrame_countChannels(masks[set])) ||
+                gloveFrame_decode(frame, size, &header, decoded) != STATUS_OK) {
+            printf("frame %u was rejected\n", set);
+            failures++;
+            continue;
+        }
+        if (header.type != type || header.seq != set ||
+                header.time != 0x10000UL * set || header.span != 100 * set ||
+                header.channelMask != masks[set]) {
+            printf("frame %u: header differs\n", set);
+            failures++;
+        }
+        count = gloveFrame_countChannels(masks[set]) *
+                GLOVEFRAME_VALUES_PER_CHANNEL;
+        for (i = 0; i < count; ++i) {
+            if (decoded[i] != values[set][i]) {
+                printf("frame %u: value %u differs\n", set, i);
+                failures++;
+                break;
+            }
+        }
+    }
+    return failures;
+}
+
+
+int main(int argc, char* argv[])
+{
+    static uint8_t frames[FRAME_SETS][GLOVEFRAME_SIZE(GLOVEFRAME_CHANNELS)];
+    static uint8_t sizes[FRAME_SETS];
+    gloveFrame_headerType header;
+    int16_t decoded[FRAME_VALUES];
+    unsigned long count = DEFAULT_FRAMES;
+    unsigned long n, bytes = 0, checksum = 0;
+    unsigned failures, set;
+    clock_t start;
+    double encodeTime, decodeTime;
+
+    if (argc > 1) {
+        count = strtoul(argv[1], NULL, 0);
+    }
+
+    makeFrames();
+    failures = checkRejects() + checkRoundTrip() + checkLayout() +
+            checkBeacon() + checkSettle() + checkPacked();
+
+    start = clock();
+    for (n = 0; n < count; ++n) {
+        set = n % FRAME_SETS;
+        sizes[set] = gloveFrame_encode(frames[set], GLOVEFRAME_TYPE_ACC,
+                (uint8_t)n, (uint32_t)n, 0, masks[set], values[set]);
+        bytes += sizes[set];
+    }
+    encodeTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (n = 0; n < count; ++n) {
+        set = n % FRAME_SETS;
+        gloveFrame_decode(frames[set], sizes[set], &header, decoded);
+        checksum += (uint16_t)decoded[0];   /* Keep the decode from being removed */
+    }
+    decodeTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("%lu frames, %lu bytes (checksum %lu)\n", count, bytes, checksum);
+    if (count > 0 && encodeTime > 0 && decodeTime > 0) {
+        printf("encode: %.1f ns/frame, %.1f MB/s\n",
+                1e9 * encodeTime / count, bytes / encodeTime / 1e6);
+        printf("decode: %.1f ns/frame, %.1f MB/s\n",
+                1e9 * decodeTime / count, bytes / decodeTime / 1e6);
+    }
+    printf("%u failures\n", failures);
+
+    return (failures == 0) ? 0 : 1;
+}
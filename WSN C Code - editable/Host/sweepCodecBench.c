@@ -0,0 +1,224 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Measures the sweep codec (see @e sweepCodec.h) on recorded gesture data.
+ *
+ * The gesture @e .dat files are read as raw readings (see gestureData.h) and
+ * compressed as two streams, one per sensor group, as the glove would. Every
+ * block is decompressed again and compared with the original.
+ *
+ * Note the recorded values have already been through the PC's 5-sample moving
+ * average, so raw glove data will compress a little less.
+ *
+ * Usage: @code sweepCodecBench [-k keyInterval] file.dat ... @endcode
+ * The default keyframe interval is 50 sweeps.
+ *
+ * @file sweepCodecBench.c
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "global.h"
+#include "sweepCodec.h"
+#include "gloveFrame.h"
+#include "gestureData.h"
+
+
+#define ACC_VALUES      GESTUREDATA_ACC_VALUES
+#define BEND_VALUES     GESTUREDATA_BEND_VALUES
+
+/* Payload size of the CC2420 driver (RF_MAX_PAYLOAD_SIZE in rf_2420.h). */
+#define RF_PAYLOAD      115
+
+/* Number of times the data is compressed when measuring the time. */
+#define TIMING_PASSES   200
+
+#define DEFAULT_KEY_INTERVAL    50
+
+
+typedef struct {
+    const char* name;
+    uint8_t count;
+    unsigned long rawBytes;
+    unsigned long blockBytes;
+    unsigned long blocks;
+    unsigned long keyframes;
+    unsigned maxBlock;
+    double encodeTime;
+    double decodeTime;
+} resultType;
+
+
+static gestureData_sweepType* sweeps = NULL;
+static unsigned long sweepCount = 0;
+static unsigned failures = 0;
+
+
+/*------------------------------------------------------------------------------
+ * Values of one group in a sweep.
+ */
+static const int16_t* groupValues(const gestureData_sweepType* sweep,
+        uint8_t count)
+{
+    return (count == ACC_VALUES) ? sweep->acc : sweep->bend;
+}
+
+
+/*------------------------------------------------------------------------------
+ * Compress and decompress one group of every sweep, checking the result, and
+ * measure the time taken.
+ */
+static void measure(resultType* result, uint8_t keyInterval)
+{
+    static uint8_t blocks[SWEEPCODEC_MAX_SIZE(SWEEPCODEC_MAX_VALUES)];
+    sweepCodec_stateType encoder, decoder;
+    int16_t values[SWEEPCODEC_MAX_VALUES];
+    uint8_t* stream;
+    uint8_t* block;
+    unsigned long n, offset;
+    unsigned pass;
+    uint8_t size, used;
+    clock_t start;
+
+    /* Check every block, and keep them for timing the decoder */
+    stream = malloc(sweepCount * SWEEPCODEC_MAX_SIZE(result->count));
+    if (stream == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    sweepCodec_init(&encoder, result->count, keyInterval);
+    sweepCodec_init(&decoder, result->count, keyInterval);
+    offset = 0;
+    for (n = 0; n < sweepCount; ++n) {
+        block = &stream[offset];
+        size = sweepCodec_encode(&encoder, groupValues(&sweeps[n], result->count),
+                block);
+        if (block[0] & SWEEPCODEC_KEYFRAME) {
+            result->keyframes++;
+        }
+        if (sweepCodec_decode(&decoder, block, size, values, &used) != STATUS_OK
+                || used != size || memcmp(values,
+                groupValues(&sweeps[n], result->count),
+                result->count * sizeof(int16_t)) != 0) {
+            printf("%s sweep %lu differs after decoding\n", result->name, n);
+            failures++;
+        }
+        result->rawBytes += 2 * result->count;
+        result->blockBytes += size;
+        result->blocks++;
+        if (size > result->maxBlock) {
+            result->maxBlock = size;
+        }
+        offset += size;
+    }
+
+    start = clock();
+    for (pass = 0; pass < TIMING_PASSES; ++pass) {
+        sweepCodec_init(&encoder, result->count, keyInterval);
+        for (n = 0; n < sweepCount; ++n) {
+            sweepCodec_encode(&encoder, groupValues(&sweeps[n], result->count),
+                    blocks);
+        }
+    }
+    result->encodeTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (pass = 0; pass < TIMING_PASSES; ++pass) {
+        sweepCodec_init(&decoder, result->count, keyInterval);
+        block = stream;
+        for (n = 0; n < sweepCount; ++n) {
+            sweepCodec_decode(&decoder, block, SWEEPCODEC_MAX_SIZE(result->count),
+                    values, &used);
+            block += used;
+        }
+    }
+    result->decodeTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    free(stream);
+}
+
+
+/*------------------------------------------------------------------------------
+ * Print the results for one group.
+ */
+static void report(const resultType* result)
+{
+    double average = (double)result->blockBytes / result->blocks;
+    double frames = (double)result->blocks * TIMING_PASSES;
+
+    printf("%s (%u values):\n", result->name, result->count);
+    printf("  %lu sweeps, %lu keyframes\n", result->blocks, result->keyframes);
+    printf("  %lu bytes raw, %lu compressed, ratio %.2f\n", result->rawBytes,
+            result->blockBytes, (double)result->rawBytes / result->blockBytes);
+    printf("  %.1f bytes/sweep on average, %u at most\n", average,
+            result->maxBlock);
+    printf("  %.1f sweeps per %u-byte payload after the frame header\n",
+            (RF_PAYLOAD - GLOVEFRAME_HEADER_SIZE) / average, RF_PAYLOAD);
+    printf("  encode %.2f us/sweep, decode %.2f us/sweep\n",
+            1e6 * result->encodeTime / frames, 1e6 * result->decodeTime / frames);
+}
+
+
+int main(int argc, char* argv[])
+{
+    resultType acc = {"accelerometers", ACC_VALUES, 0, 0, 0, 0, 0, 0, 0};
+    resultType bend = {"bend sensors", BEND_VALUES, 0, 0, 0, 0, 0, 0, 0};
+    unsigned keyInterval = DEFAULT_KEY_INTERVAL;
+    int arg = 1;
+
+    if (arg + 1 < argc && strcmp(argv[arg], "-k") == 0) {
+        keyInterval = (unsigned)strtoul(argv[arg + 1], NULL, 0);
+        arg += 2;
+    }
+    if (arg >= argc || keyInterval > 255) {
+        fprintf(stderr, "usage: %s [-k keyInterval] file.dat ...\n", argv[0]);
+        return 2;
+    }
+
+    for (; arg < argc; ++arg) {
+        sweepCount = gestureData_load(argv[arg], &sweeps, sweepCount);
+    }
+    if (sweepCount == 0) {
+        fprintf(stderr, "no sweeps found\n");
+        return 1;
+    }
+
+    measure(&acc, (uint8_t)keyInterval);
+    measure(&bend, (uint8_t)keyInterval);
+    report(&acc);
+    report(&bend);
+    printf("%u failures\n", failures);
+
+    free(sweeps);
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,236 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Checks the clock fit of @e timeSync.h against clocks with a known offset and
+ * skew: the global times it gives between and after the beacons, when it
+ * counts as synchronised, and that a beacon too far from the estimate clears
+ * the table. The local clock wraps during the test. The exit status is
+ * non-zero if any check fails.
+ *
+ * Usage: @code timeSyncTest @endcode
+ *
+ * @file timeSyncTest.c
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include "global.h"
+#include "timeSync.h"
+
+
+/* Ticks between beacons (1s of sampler time). */
+#define BEACON_TICKS    1000000L
+
+/* Local time of the first beacon, so the local clock wraps after four. */
+#define FIRST_LOCAL     0xFFC2F700UL
+
+/* Largest error allowed in a global time, in ticks. */
+#define TOLERANCE       2
+
+
+/* The reference clock, as global = local + offset + skew * (local - start). */
+typedef struct {
+    uint32_t offset;
+    double skew;
+} clockType;
+
+
+/*------------------------------------------------------------------------------
+ * Global time at a local time.
+ */
+static uint32_t globalTime(const clockType* clock, uint32_t local)
+{
+    int32_t sinceFirst = (int32_t)(local - FIRST_LOCAL);
+
+    return local + clock->offset + (int32_t)(clock->skew * sinceFirst);
+}
+
+
+/*------------------------------------------------------------------------------
+ * Check that a local time is turned into the right global time. Returns the
+ * number of failures (0 or 1).
+ */
+static unsigned checkTime(const timeSync_stateType* sync,
+        const clockType* clock, uint32_t local, const char* what)
+{
+    int32_t error = (int32_t)(timeSync_toGlobal(sync, local) -
+            globalTime(clock, local));
+
+    if (error > TOLERANCE || error < -TOLERANCE) {
+        printf("%s: %ld ticks out\n", what, (long)error);
+        return 1;
+    }
+    return 0;
+}
+
+
+/*------------------------------------------------------------------------------
+ * Feed a node's sync state beacons from a clock, and check the fit as it goes.
+ * Returns the number of failures.
+ */
+static unsigned checkClock(const clockType* clock, const char* name)
+{
+    timeSync_stateType sync;
+    uint32_t local = FIRST_LOCAL;
+    unsigned n, failures = 0;
+    char what[64];
+
+    timeSync_init(&sync);
+    if (timeSync_isSynced(&sync) || timeSync_toGlobal(&sync, 1234) != 1234) {
+        printf("%s: empty table is not local time\n", name);
+        failures++;
+    }
+
+    for (n = 0; n < 2 * TIMESYNC_TABLE_SIZE; ++n) {
+        if (timeSync_add(&sync, local, globalTime(clock, local)) != STATUS_OK) {
+            printf("%s: beacon %u was refused\n", name, n);
+            failures++;
+        }
+        if (timeSync_isSynced(&sync) != (n + 1 >= TIMESYNC_MIN_ENTRIES)) {
+            printf("%s: synchronised is wrong after %u beacons\n", name, n + 1);
+            failures++;
+        }
+
+        /* With one beacon only the offset is known */
+        if (n == 0) {
+            sprintf(what, "%s, one beacon", name);
+            failures += checkTime(&sync, clock, local, what);
+        }
+
+        /* Once the skew is known, between beacons and up to two intervals
+         * after the last one */
+        if (n >= 2) {
+            sprintf(what, "%s, at beacon %u", name, n);
+            failures += checkTime(&sync, clock, local, what);
+            sprintf(what, "%s, between beacons %u and %u", name, n - 1, n);
+            failures += checkTime(&sync, clock, local - BEACON_TICKS / 2, what);
+            sprintf(what, "%s, 2s after beacon %u", name, n);
+            failures += checkTime(&sync, clock, local + 2 * BEACON_TICKS, what);
+        }
+        local += BEACON_TICKS;
+    }
+    return failures;
+}
+
+
+/*------------------------------------------------------------------------------
+ * Check that a beacon more than TIMESYNC_MAX_ERROR from the estimate restarts
+ * the table from that beacon, and one just inside it does not. Returns the
+ * number of failures.
+ */
+static unsigned checkReset(void)
+{
+    static const clockType clock = {5000000UL, 40e-6};
+    static const clockType jumped = {5000000UL + 50000, 40e-6};
+    timeSync_stateType sync;
+    uint32_t local = FIRST_LOCAL;
+    unsigned n, failures = 0;
+
+    /* Too far out before the node is synchronised is not checked */
+    timeSync_init(&sync);
+    timeSync_add(&sync, local, globalTime(&clock, local));
+    local += BEACON_TICKS;
+    if (timeSync_add(&sync, local, globalTime(&clock, local) + 10 *
+            TIMESYNC_MAX_ERROR) != STATUS_OK || sync.count != 2) {
+        printf("beacon before synchronising was checked\n");
+        failures++;
+    }
+
+    timeSync_init(&sync);
+    local = FIRST_LOCAL;
+    for (n = 0; n < TIMESYNC_TABLE_SIZE; ++n) {
+        timeSync_add(&sync, local, globalTime(&clock, local));
+        local += BEACON_TICKS;
+    }
+
+    /* Just inside the limit */
+    if (timeSync_add(&sync, local, globalTime(&clock, local) +
+            TIMESYNC_MAX_ERROR - TOLERANCE) != STATUS_OK ||
+            !timeSync_isSynced(&sync)) {
+        printf("beacon inside TIMESYNC_MAX_ERROR cleared the table\n");
+        failures++;
+    }
+    local += BEACON_TICKS;
+
+    /* The global clock jumps */
+    if (timeSync_add(&sync, local, globalTime(&jumped, local)) !=
+            STATUS_INVALID_ARG || sync.count != 1 ||
+            timeSync_isSynced(&sync)) {
+        printf("beacon past TIMESYNC_MAX_ERROR did not clear the table\n");
+        failures++;
+    }
+    failures += checkTime(&sync, &jumped, local, "first beacon after a jump");
+
+    /* It then synchronises to the new clock */
+    for (n = 1; n < TIMESYNC_TABLE_SIZE; ++n) {
+        local += BEACON_TICKS;
+        if (timeSync_add(&sync, local, globalTime(&jumped, local)) !=
+                STATUS_OK) {
+            printf("beacon %u after a jump was refused\n", n);
+            failures++;
+        }
+    }
+    failures += checkTime(&sync, &jumped, local + BEACON_TICKS,
+            "synchronised again after a jump");
+
+    /* And back */
+    local += BEACON_TICKS;
+    if (timeSync_add(&sync, local, globalTime(&clock, local)) !=
+            STATUS_INVALID_ARG || sync.count != 1) {
+        printf("beacon behind by TIMESYNC_MAX_ERROR did not clear the table\n");
+        failures++;
+    }
+
+    return failures;
+}
+
+
+int main(void)
+{
+    /* Crystals are within about 50ppm, so the skew can be up to 100ppm */
+    static const clockType clocks[] = {
+        {0, 0},
+        {123456789UL, 50e-6},
+        {0xFFFFFF00UL, -100e-6},
+        {3000000000UL, 7.5e-6}
+    };
+    unsigned i, failures = 0;
+    char name[32];
+
+    for (i = 0; i < sizeof(clocks) / sizeof(clocks[0]); ++i) {
+        sprintf(name, "clock %u", i);
+        failures += checkClock(&clocks[i], name);
+    }
+    failures += checkReset();
+
+    printf("%u failures\n", failures);
+
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Decodes the binary UART frames sent by the glove (see @e uartFrame.h) and
+ * prints each sweep in the same comma separated format as the glove's ASCII
+ * debugging output:
+ * @verbatim
+       <time>,<acc 1x>,<acc 1y>,<acc 1z>, ... <acc 16z>,<bend 1>, ... <bend 6>*@endverbatim
+ *
+ * Accelerometer values are in g and bend sensor values are in volts. With
+ * @c -r the raw samples of every frame are printed instead. With @c -n a
+ * first line of column names is printed, taken from @e gloveSensors.h.
+ *
+ * Usage: @code uartFrameDump [-r] [-n] [file] @endcode
+ * If no file is given, standard input is read, e.g. from a serial port that
+ * was set up with @e stty.
+ *
+ * @file uartFrameDump.c
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "global.h"
+#include "uartFrame.h"
+#include "gloveSensors.h"
+
+
+/* Samples in each glove frame (16 sensors with three values each). */
+#define GLOVE_SAMPLES       (3 * GLOVESENSORS_POSITIONS)
+
+/* Number of bend sensor values printed per sweep (ASCII mode prints 6). */
+#define BEND_PRINTED        6
+
+/* Accelerometer scale in full resolution mode (g per LSB). */
+#define ACC_G_PER_LSB       (1.0 / GLOVESENSORS_ACC_LSB_PER_G)
+
+/* Bend sensor scale (volts per LSB). */
+#define BEND_V_PER_LSB      (GLOVESENSORS_BEND_REF_MV / 1000.0 / \
+                             (1 << GLOVESENSORS_BEND_BITS))
+
+/* Timestamp units per second (F_CPU / 8 on the glove, see sampler.h). */
+#define TIME_PER_SECOND     1000000UL
+
+
+static void printNames(void);
+static void printRaw(const uartFrame_decoderType* frame);
+static void printSweep(const uartFrame_decoderType* frame,
+        const int16_t* acc, uint8_t accCount);
+
+
+int main(int argc, char* argv[])
+{
+    static uartFrame_decoderType decoder;
+    int16_t acc[UARTFRAME_MAX_SAMPLES];
+    uint8_t accCount = 0;
+    uint8_t accSeq = 0;
+    bool isRaw = false;
+    bool isNamed = false;
+    unsigned long frames = 0;
+    FILE* in = stdin;
+    int ch;
+
+    while (argc > 1 && argv[1][0] == '-' && argv[1][1] != '\0') {
+        if (strcmp(argv[1], "-r") == 0) {
+            isRaw = true;
+        } else if (strcmp(argv[1], "-n") == 0) {
+            isNamed = true;
+        } else {
+            fprintf(stderr, "Usage: uartFrameDump [-r] [-n] [file]\n");
+            return 1;
+        }
+        argc--;
+        argv++;
+    }
+    if (argc > 1) {
+        in = fopen(argv[1], "rb");
+        if (in == NULL) {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    if (isNamed && !isRaw) printNames();
+    uartFrame_decoderInit(&decoder);
+    while ((ch = getc(in)) != EOF) {
+        if (!uartFrame_decode(&decoder, (uint8_t)ch)) continue;
+        frames++;
+
+        if (isRaw) {
+            printRaw(&decoder);
+        } else if (decoder.type == UARTFRAME_TYPE_ACC) {
+            memcpy(acc, decoder.samples, decoder.count * sizeof(acc[0]));
+            accCount = decoder.count;
+            accSeq = decoder.seq;
+        } else if (decoder.type == UARTFRAME_TYPE_BEND &&
+                decoder.seq == accSeq && accCount != 0) {
+            printSweep(&decoder, acc, accCount);
+            accCount = 0;
+        }
+    }
+
+    fprintf(stderr, "%lu frames, %u CRC errors, %u lost\n", frames,
+            decoder.crcErrors, decoder.lostFrames);
+    if (in != stdin) fclose(in);
+    return 0;
+}
+
+
+/*------------------------------------------------------------------------------
+ * Print the name of each column printed by printSweep().
+ */
+static void printNames(void)
+{
+    static const gloveSensors_labelType bendLabels[GLOVESENSORS_POSITIONS][3] = {
+        GLOVESENSORS_MAP(GLOVESENSORS_LABELS)
+    };
+    uint8_t i;
+
+    printf("time");
+    for (i = 0; i < GLOVE_SAMPLES; ++i) {
+        printf(",%s%X%c", GLOVESENSORS_ACC_NAME, i / 3,
+                GLOVESENSORS_ACC_AXES[i % 3]);
+    }
+    for (i = 0; i < BEND_PRINTED; ++i) {
+        printf(",%s%X", bendLabels[i][0].name, bendLabels[i][0].number);
+    }
+    printf("\n");
+}
+
+
+/*------------------------------------------------------------------------------
+ * Print every field of a frame.
+ */
+static void printRaw(const uartFrame_decoderType* frame)
+{
+    uint8_t i;
+
+    printf("type=%u seq=%u time=%lu", frame->type, frame->seq,
+            (unsigned long)frame->time);
+    for (i = 0; i < frame->count; ++i) {
+        printf(" %d", frame->samples[i]);
+    }
+    printf("\n");
+}
+
+
+/*------------------------------------------------------------------------------
+ * Print an accelerometer frame and the bend frame from the same sweep as one
+ * line. Only the first ADC channel of the first BEND_PRINTED bend sensors is
+ * printed, as in the glove's ASCII output.
+ */
+static void printSweep(const uartFrame_decoderType* frame,
+        const int16_t* acc, uint8_t accCount)
+{
+    uint8_t i;
+
+    printf("%lu.%06lu", (unsigned long)(frame->time / TIME_PER_SECOND),
+            (unsigned long)(frame->time % TIME_PER_SECOND));
+    for (i = 0; i < accCount && i < GLOVE_SAMPLES; ++i) {
+        printf(",%f", acc[i] * ACC_G_PER_LSB);
+    }
+    for (i = 0; i < BEND_PRINTED && 3 * i < frame->count; ++i) {
+        printf(",%f", (frame->samples[3 * i] & GLOVESENSORS_BEND_MASK) * BEND_V_PER_LSB);
+    }
+    printf("*\n");
+}
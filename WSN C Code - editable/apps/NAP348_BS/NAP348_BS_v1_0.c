@@ -43,18 +43,99 @@
 #include "sleep.h"
 #include "simpleIo.h"
 #include "delay.h"
+#include "gloveFrame.h"
+#include "fixedPoint.h"
+#include "deadband.h"
+#include "gloveSensors.h"
+#include "sampler.h"
 
 #define DEST_ADDR       0x0100
+#define GLOVE_ADDR      0x7979
 
-static volatile bool isReceived = false;
-static volatile rf_msgType receivedMsg;
-static volatile uint8_t buffer[RF_MAX_PAYLOAD_SIZE];
+/* Frames sent by the glove are decoded with gloveFrame.h. Frames of another
+ * version or of an unknown type are ignored. */
+static gloveFrame_headerType frameHeader;
+static int16_t frameValues[GLOVEFRAME_CHANNELS * GLOVEFRAME_VALUES_PER_CHANNEL];
+
+/* Last value of every sensor, to fill in the ones a glove using GLOVE_DEADBAND
+ * did not send */
+static deadband_stateType accDeadband;
+static deadband_stateType bendDeadband;
+
+/* Labels for the values of a bend frame, in frame order */
+static const gloveSensors_labelType bendLabels[GLOVESENSORS_POSITIONS][GLOVEFRAME_VALUES_PER_CHANNEL] = {
+    GLOVESENSORS_MAP(GLOVESENSORS_LABELS)
+};
+static void putLabel(const char* name, uint8_t number);
+static void putHeader(void);
+
+/* Decoders for the sweeps in packed frames from a glove using GLOVE_PACK, and
+ * the sequence number of the last packed frame of each type */
+static sweepCodec_stateType accCodec;
+static sweepCodec_stateType bendCodec;
+static uint8_t accPackSeq;
+static uint8_t bendPackSeq;
+static sweepCodec_stateType* packCodec;
+static uint8_t packOffset;
+static bool isPacked;
+static void startPacked(void);
+static bool nextSweep(void);
+
+#ifdef UART_USE_CALLBACK
+/* Rate command from the PC, forwarded to the glove as a rate frame (see
+ * gloveFrame.h): 'R', frame type, sweeps per second (low byte first) */
+#define RATE_COMMAND_SIZE  4
+static volatile uint8_t rateCommand[RATE_COMMAND_SIZE];
+static volatile uint8_t rateCommandLength = 0;
+static uint8_t rateFrame[GLOVEFRAME_RATE_SIZE];
+#endif
+
+#ifdef BS_TDMA_GLOVES
+/* Gloves given a transmit slot in each superframe, in slot order (see
+ * gloveFrame.h). Slots without an address are left empty. */
+#ifndef BS_TDMA_SLOTS
+#define BS_TDMA_SLOTS  2
+#endif
+#ifndef BS_TDMA_SLOT_US
+#define BS_TDMA_SLOT_US  10000
+#endif
+#if BS_TDMA_SLOTS > GLOVEFRAME_MAX_SLOTS
+#error "BS_TDMA_SLOTS is more than a beacon frame can hold"
+#endif
+#if (BS_TDMA_SLOTS + 1) * BS_TDMA_SLOT_US > 0xFFFF
+#error "The superframe must be shorter than 65536us"
+#endif
+#define SUPERFRAME_US  ((BS_TDMA_SLOTS + 1) * (uint32_t)BS_TDMA_SLOT_US)
+static const uint16_t tdmaGloves[BS_TDMA_SLOTS] = {BS_TDMA_GLOVES};
+static uint8_t beaconFrame[GLOVEFRAME_BEACON_SIZE(BS_TDMA_SLOTS)];
+static uint8_t beaconSeq = 0;
+static uint32_t beaconSent = 0;
+static uint32_t nextBeacon;
+static void sendBeacon(void);
+#endif
+
+#ifdef BS_TIME_SYNC_MS
+#ifdef BS_TDMA_GLOVES
+#error "The beacons already carry the time, BS_TIME_SYNC_MS is not needed with BS_TDMA_GLOVES"
+#endif
+/* Sync frames with the base station's time (see gloveFrame.h) */
+static uint8_t syncFrame[GLOVEFRAME_SIZE(0)];
+static uint8_t syncSeq = 0;
+static uint32_t syncSent = 0;
+static uint32_t nextSync;
+static void sendSync(void);
+#endif
+
+/* Packets wait here while earlier ones are printed */
+#define RX_QUEUE_SIZE   4
+static volatile rf_msgType rxMsgs[RX_QUEUE_SIZE];
+static volatile uint8_t rxBuffers[RX_QUEUE_SIZE][RF_MAX_PAYLOAD_SIZE];
+static rf_queueType rxQueue = {rxMsgs, RX_QUEUE_SIZE, 0, 0, 0};
+static volatile rf_msgType* receivedMsg;
 
 //static volatile uint8_t txBuffer[RF_MAX_PAYLOAD_SIZE];
 
-uint8_t Bdata[25];
 static uint8_t i,j;
-static double tempresult;
 int main(void)
 {
     /* Initialise everything */
@@ -62,25 +143,73 @@ int main(void)
     //led_init();
     uart_init();
     rf_init(RF_CHANNEL_CENTRE, RF_PWR_MAX);
-    receivedMsg.data = buffer;
+    for (i = 0; i < RX_QUEUE_SIZE; i++) {
+        rxMsgs[i].data = rxBuffers[i];
+    }
+    deadband_init(&accDeadband, NULL, 0, 0);
+    deadband_init(&bendDeadband, NULL, 0, 0);
+    sweepCodec_init(&accCodec, GLOVEFRAME_CHANNELS * GLOVEFRAME_VALUES_PER_CHANNEL, 0);
+    sweepCodec_init(&bendCodec, GLOVEFRAME_CHANNELS * GLOVEFRAME_VALUES_PER_CHANNEL, 0);
    // printf("\nrfToUart\n");
 
     /* Turn radio on to RX mode */
-    rf_setReceiveBuffer(&receivedMsg);
+    rf_setReceiveQueue(&rxQueue);
     rf_setMode(RF_MODE_RECEIVING);
+#if defined(BS_TDMA_GLOVES) || defined(BS_TIME_SYNC_MS)
+    /* Only the sampler's free-running time is used */
+    sampler_init(SAMPLER_MIN_RATE);
+    sampler_stop();
+#endif
+#ifdef BS_TDMA_GLOVES
+    nextBeacon = sampler_getTime();
+#endif
+#ifdef BS_TIME_SYNC_MS
+    nextSync = sampler_getTime();
+#endif
 
     /* Go to sleep now, and after each packet is received */
     for(;;) {
 
-        while (!isReceived) {
+        while ((receivedMsg = rf_queuePeek(&rxQueue)) == NULL) {
             delay_us(250);
+#ifdef BS_TDMA_GLOVES
+            sendBeacon();
+#endif
+#ifdef BS_TIME_SYNC_MS
+            sendSync();
+#endif
+#ifdef UART_USE_CALLBACK
+            if (rateCommandLength == RATE_COMMAND_SIZE) {
+                gloveFrame_writeRate(rateFrame, rateCommand[1],
+                        TO_UINT16(rateCommand[3], rateCommand[2]));
+#ifdef RF_USE_ACK
+                /* Retried until the glove acknowledges it */
+                rf_sendAcked(GLOVE_ADDR, rateFrame, GLOVEFRAME_RATE_SIZE);
+#else
+                rf_send(GLOVE_ADDR, rateFrame, GLOVEFRAME_RATE_SIZE);
+#endif
+                rateCommandLength = 0;
+            }
+#endif
         }
-        isReceived = false;
 		
 
 		
-		if((receivedMsg.data[0] =='A')&&(receivedMsg.data[1] =='C'))
+		if(gloveFrame_decode((const uint8_t*)receivedMsg->data,receivedMsg->length,&frameHeader,frameValues) != STATUS_OK)
+		{
+			rf_queueRelease(&rxQueue);
+			continue;
+		}
+		
+		/* A packed frame is printed as the sweeps in it, one at a time */
+		isPacked = (frameHeader.type == GLOVEFRAME_TYPE_PACKED);
+		if(isPacked)startPacked();
+		do {
+		if(isPacked && !nextSweep())break;
+		if(frameHeader.type == GLOVEFRAME_TYPE_ACC)
 		{
+		deadband_receive(&accDeadband,frameHeader.channelMask,frameValues);
+		putHeader();
 		
     
 		for(j=0;j<16;j++)
@@ -88,29 +217,13 @@ int main(void)
 				for (i=0;i<3;i++)
 		{
 		
-		if(0x80&receivedMsg.data[1+2*i+6*j+3])tempresult=((((receivedMsg.data[0+2*i+6*j+3])^0xFF)+1)+256*((((receivedMsg.data[2*i+1+6*j+3])^0xFF))))*(-1.0/256);
-		else tempresult=(receivedMsg.data[2*i+6*j+3]+256*(receivedMsg.data[2*i+1+6*j+3]))*(1.0/256);
-		snprintf(&Bdata[0],9,"%f",tempresult);
 	
 			//putchar(' ');
-			putchar('A');
-			putchar('C');
-			putchar('C');
-			putHex_JT(j);
-			putchar(' ');
-			if(i==0)putchar('X');
-			else if (i==1)putchar('Y');
-			else putchar('Z');
+			putLabel(GLOVESENSORS_ACC_NAME, j);
+			putchar(GLOVESENSORS_ACC_AXES[i]);
 			//putchar(' ');
-			putchar(Bdata[0]);
-			putchar(Bdata[1]);
-			putchar(Bdata[2]);
-			putchar(Bdata[3]);
-			putchar(Bdata[4]);
-			putchar(Bdata[5]);
-			putchar(Bdata[6]);
-			putchar(Bdata[7]);
-			putchar(Bdata[8]);
+			/* g, to the nearest milli-g */
+			fixedPoint_put(fixedPoint_accToMilliG(frameValues[3*j+i]),3);
 					
 		}
 		}
@@ -125,101 +238,20 @@ int main(void)
 			putchar('T');
 			putchar('A');
 
-}else{
+}else if(frameHeader.type == GLOVEFRAME_TYPE_BEND){
+deadband_receive(&bendDeadband,frameHeader.channelMask,frameValues);
+putHeader();
 for(j=0;j<16;j++)
 		{
 			for (i=0;i<3;i++)
 		{
 		
-		tempresult=(receivedMsg.data[2*i+1+6*j+3]+256*((receivedMsg.data[2*i+6*j+3])&0x03))*(3.3/1024);
-		
-		snprintf(&Bdata[0],9,"%f",tempresult);
 
 			
-			if(j<4)
-			{
-			
-				if(i==0)
-				{
-				putchar('B');
-				putchar('E');
-				putchar('N');
-				putchar('D');
-				putHex_JT(j);
-				putchar(' ');
-				//putchar(' ');
-			
-				}else if (i==1)
-			
-				{
-				putchar('S');
-				putchar('P');
-				putchar('L');
-				putchar('A');
-				putHex_JT(j);
-				putchar(' ');
-				//putchar(' ');
-						
-			
-				} else 
-				{
-		
-				putchar('B');
-				putchar('I');
-				putchar('A');
-				putchar('S');
-				putHex_JT(j);
-				putchar(' ');
-				//putchar(' ');
-		
-					}
-			
-			}else{
-							if(i==0)
-				{
-				putchar('B');
-				putchar('E');
-				putchar('N');
-				putchar('D');
-				putHex_JT(j);
-				putchar(' ');
-				//putchar(' ');
-		
-				}else if (i==1)
-			
-				{
-				putchar('F');
-				putchar('O');
-				putchar('R');
-				putchar('C');
-				putHex_JT((j-4));
-				putchar(' ');
-				//putchar(' ');
-				
-			
-				} else 
-				{
-		
-				putchar('B');
-				putchar('I');
-				putchar('A');
-				putchar('S');
-				putHex_JT(j);
-				putchar(' ');
-				//putchar(' ');
-			
-					}
-			
-			}
-			putchar(Bdata[0]);
-			putchar(Bdata[1]);
-			putchar(Bdata[2]);
-			putchar(Bdata[3]);
-			putchar(Bdata[4]);
-			putchar(Bdata[5]);
-			putchar(Bdata[6]);
-			putchar(Bdata[7]);
-			putchar(Bdata[8]);
+			putLabel(bendLabels[j][i].name, bendLabels[j][i].number);
+
+			/* Volts, to the nearest millivolt */
+			fixedPoint_put(fixedPoint_adcToMilliVolts(frameValues[3*j+i]&GLOVESENSORS_BEND_MASK,GLOVESENSORS_BEND_REF_MV,GLOVESENSORS_BEND_BITS),3);
 
 		//	putchar(0x0A);
 		//	putchar(0x0D);
@@ -239,7 +271,26 @@ for(j=0;j<16;j++)
 			putchar('T');
 			putchar('A');
 
+}else if(frameHeader.type == GLOVEFRAME_TYPE_GESTURE){
+			/* Gesture recognised on the glove (numbered as in GestureTypes.dat) */
+			putHeader();
+			simpleIo_puts("GESTURE ");
+			putUNum(receivedMsg->data[GLOVEFRAME_GESTURE_OFFSET]);
+			simpleIo_puts(" ENDOFDATA");
+}else if(frameHeader.type == GLOVEFRAME_TYPE_SETTLE){
+			/* Settling conversions before each bend value, in frame order, from
+			 * which gloveFrame_bendOffset() gives when each was read */
+			putHeader();
+			simpleIo_puts("SETTLE");
+			for(j=0;j<GLOVEFRAME_CHANNELS * GLOVEFRAME_VALUES_PER_CHANNEL;j++)
+			{
+				putchar(' ');
+				putUNum(receivedMsg->data[GLOVEFRAME_SETTLE_OFFSET + j]);
+			}
+			simpleIo_puts(" ENDOFDATA");
 }
+		} while(isPacked);
+		rf_queueRelease(&rxQueue);
 /*
   	if(receivedMsg.data[0] =='A'){
 		for(j=0;j<16;j++)
@@ -404,6 +455,154 @@ for(j=0;j<16;j++)
 			}
 }
 
+/*------------------------------------------------------------------------------
+ * Print a sensor label: its name, its number in hex and a space.
+ */
+static void putLabel(const char* name, uint8_t number)
+{
+    while (*name != '\0') {
+        putchar(*name++);
+    }
+    putHex_JT(number);
+    putchar(' ');
+}
+
+/*------------------------------------------------------------------------------
+ * Print the sequence number, time and span of the frame (or packed sweep) in
+ * frameHeader, each after its name and followed by a space, to start its line.
+ */
+static void putHeader(void)
+{
+    char digits[10];
+    uint8_t count = 0;
+    uint32_t time = frameHeader.time;
+
+    simpleIo_puts("SEQ ");
+    putUNum(frameHeader.seq);
+    simpleIo_puts(" TIME ");
+    /* putUNum() only takes 16 bits */
+    do {
+        digits[count++] = '0' + time % 10;
+        time /= 10;
+    } while (time != 0);
+    while (count != 0) {
+        putchar(digits[--count]);
+    }
+    simpleIo_puts(" SPAN ");
+    putUNum(frameHeader.span);
+    putchar(' ');
+}
+
+/*------------------------------------------------------------------------------
+ * Pick the decoder for the packed frame in receivedMsg. If a packed frame of
+ * its type has been lost, the decoder waits for the next keyframe.
+ */
+static void startPacked(void)
+{
+    uint8_t* lastSeq;
+
+    if (receivedMsg->data[GLOVEFRAME_PACKED_OFFSET] == GLOVEFRAME_TYPE_ACC) {
+        packCodec = &accCodec;
+        lastSeq = &accPackSeq;
+    } else if (receivedMsg->data[GLOVEFRAME_PACKED_OFFSET] == GLOVEFRAME_TYPE_BEND) {
+        packCodec = &bendCodec;
+        lastSeq = &bendPackSeq;
+    } else {
+        packCodec = NULL;
+        return;
+    }
+    if (frameHeader.seq != (uint8_t)(*lastSeq + 1)) {
+        sweepCodec_reset(packCodec);
+    }
+    *lastSeq = frameHeader.seq;
+    packOffset = GLOVEFRAME_PACKED_SIZE;
+}
+
+/*------------------------------------------------------------------------------
+ * Read the next sweep of the packed frame in receivedMsg into frameHeader and
+ * frameValues. Sweeps that can't be decoded without a lost keyframe are
+ * skipped. Returns false when there are no more.
+ */
+static bool nextSweep(void)
+{
+    status_t status;
+
+    if (packCodec == NULL) {
+        return false;
+    }
+    do {
+        if (packOffset >= receivedMsg->length) {
+            return false;
+        }
+        status = gloveFrame_readSweep((const uint8_t*)receivedMsg->data,
+                receivedMsg->length, &packOffset, packCodec, &frameHeader,
+                frameValues);
+        if (status == STATUS_INVALID_ARG) {
+            /* The rest of the frame can't be trusted */
+            sweepCodec_reset(packCodec);
+            return false;
+        }
+    } while (status != STATUS_OK);
+    return true;
+}
+
+#ifdef BS_TDMA_GLOVES
+/*------------------------------------------------------------------------------
+ * Broadcast a beacon if the next superframe is due. Beacons stay on the
+ * superframe grid: one more than half a slot late (while a frame was being
+ * printed) is skipped, and the gloves keep to the previous superframe. Each
+ * beacon carries the time the one before it was sent.
+ */
+static void sendBeacon(void)
+{
+    uint32_t now = sampler_getTime();
+    uint32_t late = now - nextBeacon;
+    uint16_t sent;
+
+    if ((int32_t)late < 0) {
+        return;
+    }
+    nextBeacon += (late / SUPERFRAME_US + 1) * SUPERFRAME_US;
+    if (late % SUPERFRAME_US > BS_TDMA_SLOT_US / 2) {
+        return;
+    }
+    rf_send(RF_BROADCAST_ADDRESS, beaconFrame,
+            gloveFrame_writeBeacon(beaconFrame, beaconSeq, beaconSent,
+                    BS_TDMA_SLOT_US, BS_TDMA_SLOTS, tdmaGloves));
+    if (rf_getTxTime(&sent) == STATUS_OK) {
+        now = sampler_getTime();
+        beaconSent = now - (uint16_t)((uint16_t)now - sent);
+        beaconSeq++;
+    }
+}
+
+#endif
+#ifdef BS_TIME_SYNC_MS
+/*------------------------------------------------------------------------------
+ * Broadcast the time if BS_TIME_SYNC_MS have passed since the last sync frame.
+ * The radio timestamps the frame as it goes out, after any wait for the
+ * channel, and the time is sent in the next sync frame.
+ */
+static void sendSync(void)
+{
+    uint32_t now = sampler_getTime();
+    uint16_t sent;
+
+    if ((int32_t)(now - nextSync) < 0) {
+        return;
+    }
+    nextSync = now + BS_TIME_SYNC_MS * (SAMPLER_TICKS_PER_SECOND / 1000);
+    rf_send(RF_BROADCAST_ADDRESS, syncFrame,
+            gloveFrame_writeHeader(syncFrame, GLOVEFRAME_TYPE_SYNC, syncSeq,
+                    syncSent, 0, 0));
+    if (rf_getTxTime(&sent) == STATUS_OK) {
+        now = sampler_getTime();
+        syncSent = now - (uint16_t)((uint16_t)now - sent);
+        syncSeq++;
+    }
+}
+
+#endif
 /*------------------------------------------------------------------------------
  * Handler for received packets. Flashes LED_0.
  */
@@ -411,6 +610,21 @@ void rf_callback(volatile rf_msgType* msg)
 {
     UNUSED(msg);
     led_toggle(LED_0);
+}
 
-    isReceived = 1;
+#ifdef UART_USE_CALLBACK
+/*------------------------------------------------------------------------------
+ * Collect a rate command from the PC. Bytes before the 'R' are ignored, and
+ * bytes after a complete command until it has been sent.
+ */
+void uart_callback(uint8_t received)
+{
+    if (rateCommandLength == RATE_COMMAND_SIZE) {
+        return;
+    }
+    if (rateCommandLength == 0 && received != GLOVEFRAME_TYPE_RATE) {
+        return;
+    }
+    rateCommand[rateCommandLength++] = received;
 }
+#endif
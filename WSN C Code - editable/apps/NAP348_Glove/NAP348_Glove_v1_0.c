@@ -44,9 +44,20 @@
 #include "rf.h"
 #include "uart.h"
 #include "simpleIo.h"
+#include "fixedPoint.h"
+#include "sampler.h"
+#include "uartFrame.h"
+#include "gloveFrame.h"
+#include "boxcar.h"
+#include "gesture.h"
+#include "deadband.h"
+#include "gloveSensors.h"
+#include "timeSync.h"
+#include "eeprom_mcu.h"
 //#include "externInt.h"
 
-#include "spi_adxl345.c"
+#include "spi_adxl345.h"
+#include "adxl345.h"
 
 /* Address to send to (see rfToUart application makefile) */
 #define DEST_ADDR       0x8480
@@ -125,53 +136,910 @@
 
 #define DEBUGGING_ON  1
 
+/* Set to 1 to write the debugging output as binary frames (see uartFrame.h and
+ * Host/uartFrameDump.c) instead of text, can be overridden in the makefile. */
+#ifndef DEBUGGING_BINARY
+#define DEBUGGING_BINARY  0
+#endif
+
+/* Number of samples in a sweep (16 sensors, 3 values each) */
+#define SWEEP_SAMPLES  48
+
+/* ADC channels read at each bend mux position, in the order they are sent */
+#define BEND_CHANNELS  3
+static const uint8_t bendChannels[BEND_CHANNELS] = {ADC_CH_ADC2, ADC_CH_ADC1, ADC_CH_ADC3};
+
+/* Conversions thrown away before the first reading at each bend mux position
+ * (about 104us each), used until the settle table has been calibrated. The
+ * scan is pipelined, so the mux is moved while the previous reading is still
+ * being converted, and this gives about 600us. */
+#define BEND_SETTLE  5
+
+/* Longest settling time tried and allowed error (in ADC counts) when the bend
+ * settle table is calibrated */
+#define BEND_SETTLE_MAX  10
+#define BEND_SETTLE_TOLERANCE  2
+
+/* The bend settle table is kept in the MCU EEPROM after a two byte marker
+ * (see loadBendSettle()) */
+#define SETTLE_EEPROM_START  0x0000
+#define SETTLE_EEPROM_MARKER  'S'
+
+/* The settle table is sent in a settle frame (see gloveFrame.h) with the first
+ * bend sweep and then every GLOVE_SETTLE_SWEEPS bend sweeps, so the base
+ * station can tell when each bend value was read */
+#ifndef GLOVE_SETTLE_SWEEPS
+#define GLOVE_SETTLE_SWEEPS  250
+#endif
+
+/* The accelerometer offsets (OFSX, OFSY, OFSZ of each ADXL345) are kept after
+ * the settle table, also behind a two byte marker (see loadAccOffsets()) */
+#define OFFSET_EEPROM_START  (SETTLE_EEPROM_START + 2 + SWEEP_SAMPLES)
+#define OFFSET_EEPROM_MARKER  'O'
+
+/* Readings averaged for each ADXL345 when the offsets are calibrated */
+#define ACC_OFFSET_SAMPLES  32
+
+/* Radio frames always carry all 16 sensors (see gloveFrame.h) */
+#define FRAME_LENGTH  GLOVEFRAME_SIZE(GLOVEFRAME_CHANNELS)
+
+/* Frame times are in microseconds, which is the sampler time at 8MHz */
+#if SAMPLER_TICKS_PER_SECOND != 1000000UL
+#error "The sampler time is not in microseconds, convert it for the frames"
+#endif
+
+/* Sensor sweeps per second, can be overridden in the makefile. */
+#ifndef GLOVE_SAMPLE_RATE
+#define GLOVE_SAMPLE_RATE  50
+#endif
+
+/* The accelerometers and the bend sensors are swept at their own rates, each
+ * in its own sampler group (see sampler.h). Both default to GLOVE_SAMPLE_RATE.
+ * The bend sensors share the mux address lines with the accelerometers, so an
+ * accelerometer sweep that falls due during a bend scan is read as soon as the
+ * scan ends; its time stamp is taken when it is actually read. */
+#ifndef GLOVE_ACC_SWEEP_RATE
+#define GLOVE_ACC_SWEEP_RATE  GLOVE_SAMPLE_RATE
+#endif
+#ifndef GLOVE_BEND_SWEEP_RATE
+#define GLOVE_BEND_SWEEP_RATE  GLOVE_SAMPLE_RATE
+#endif
+#define ACC_GROUP  0
+#define BEND_GROUP  1
+
+/* Set GLOVE_REMOTE_RATES to 1 in the makefile to let the base station change
+ * the sweep rates with rate frames (see gloveFrame.h). The radio is then left
+ * receiving, so each rf_send() waits for the frame to go out before it
+ * returns. */
+#ifndef GLOVE_REMOTE_RATES
+#define GLOVE_REMOTE_RATES  0
+#endif
+
+/* Set GLOVE_TDMA to 1 in the makefile to only transmit in the slot that the
+ * base station's beacon frames give this glove (see gloveFrame.h). The radio
+ * is left receiving. Once a beacon has arrived both groups sweep once per
+ * superframe, starting GLOVE_TDMA_LEAD us before the glove's slot, in place of
+ * GLOVE_ACC_SWEEP_RATE and GLOVE_BEND_SWEEP_RATE. Frames wait in their buffers
+ * for the slot, and are only sent if they will end GLOVE_TDMA_GUARD us before
+ * it does. Nothing is sent until a beacon gives the glove a slot, and a frame
+ * finished while all the other buffers are waiting is dropped. */
+#ifndef GLOVE_TDMA
+#define GLOVE_TDMA  0
+#endif
+#ifndef GLOVE_TDMA_LEAD
+#define GLOVE_TDMA_LEAD  15000
+#endif
+#ifndef GLOVE_TDMA_GUARD
+#define GLOVE_TDMA_GUARD  500
+#endif
+#define SLOT_GROUP  2
+
+#if GLOVE_TDMA
+#if !defined(RF_USE_TX_QUEUE) || !defined(RF_AIR_TIME_US)
+#error "GLOVE_TDMA needs the CC2420 and RF_USE_TX_QUEUE"
+#endif
+#ifdef RF_CARRIER_DETECT
+#error "Turn off RF_CARRIER_DETECT with GLOVE_TDMA, backoffs would run past the end of the slot"
+#endif
+#if GLOVE_REMOTE_RATES
+#error "GLOVE_TDMA sets the sweep rates from the beacons, turn off GLOVE_REMOTE_RATES"
+#endif
+#endif
+
+/* Set GLOVE_TIME_SYNC to 1 in the makefile to give frame times in the base
+ * station's time, kept from its sync or beacon frames (see timeSync.h). The
+ * radio is left receiving. At most one frame every GLOVE_SYNC_INTERVAL_MS is
+ * used, so that the clock drift is fitted over several seconds. */
+#ifndef GLOVE_TIME_SYNC
+#define GLOVE_TIME_SYNC  0
+#endif
+#ifndef GLOVE_SYNC_INTERVAL_MS
+#define GLOVE_SYNC_INTERVAL_MS  1000
+#endif
+#if GLOVE_TIME_SYNC && !defined(RADIO_2420)
+#error "GLOVE_TIME_SYNC needs the SFD timestamps of the CC2420"
+#endif
+
+/* The radio is left receiving for rate, beacon and sync frames */
+#define GLOVE_RECEIVE  (GLOVE_REMOTE_RATES || GLOVE_TDMA || GLOVE_TIME_SYNC)
+
+/* Set GLOVE_ACC_FIFO to 1 in the makefile to run the accelerometers from their
+ * FIFOs at GLOVE_ACC_RATE samples per second. Each sweep then reads
+ * ACC_FIFO_SAMPLES samples from each ADXL345 in one burst, and sends one
+ * accelerometer frame per sample. */
+#ifndef GLOVE_ACC_FIFO
+#define GLOVE_ACC_FIFO  0
+#endif
+#ifndef GLOVE_ACC_RATE
+#define GLOVE_ACC_RATE  200
+#endif
+
+#if GLOVE_ACC_FIFO
+#define ACC_FIFO_SAMPLES  (GLOVE_ACC_RATE / GLOVE_ACC_SWEEP_RATE)
+#if ACC_FIFO_SAMPLES < 1 || ACC_FIFO_SAMPLES >= ADXL345_FIFO_SIZE
+#error "GLOVE_ACC_RATE / GLOVE_ACC_SWEEP_RATE must be from 1 to 31"
+#endif
+#if GLOVE_ACC_RATE == 100
+#define ACC_RATE_CODE  ADXL345_RATE_100HZ
+#elif GLOVE_ACC_RATE == 200
+#define ACC_RATE_CODE  ADXL345_RATE_200HZ
+#elif GLOVE_ACC_RATE == 400
+#define ACC_RATE_CODE  ADXL345_RATE_400HZ
+#elif GLOVE_ACC_RATE == 800
+#define ACC_RATE_CODE  ADXL345_RATE_800HZ
+#elif GLOVE_ACC_RATE == 1600
+#define ACC_RATE_CODE  ADXL345_RATE_1600HZ
+#else
+#error "GLOVE_ACC_RATE must be 100, 200, 400, 800 or 1600"
+#endif
+/* Sampler ticks between accelerometer samples */
+#define ACC_PERIOD  (SAMPLER_TICKS_PER_SECOND / GLOVE_ACC_RATE)
+#endif
+
+/* Frames can be smoothed before they are sent, by averaging the last
+ * GLOVE_FILTER_LENGTH frames of each type and only sending every
+ * GLOVE_FILTER_DECIMATION-th average (see boxcar.h). Both default to 1, which
+ * sends the raw values. */
+#ifndef GLOVE_FILTER_LENGTH
+#define GLOVE_FILTER_LENGTH  1
+#endif
+#ifndef GLOVE_FILTER_DECIMATION
+#define GLOVE_FILTER_DECIMATION  1
+#endif
+#define GLOVE_FILTER  (GLOVE_FILTER_LENGTH > 1 || GLOVE_FILTER_DECIMATION > 1)
+
+/* Set GLOVE_CLASSIFY to 1 in the makefile to recognise gestures on the glove
+ * (see gesture.h). A gesture frame is then sent whenever the recognised gesture
+ * changes, and the raw frames only every GLOVE_KEYFRAME_SWEEPS sweeps. The
+ * centroids are in gestureModel.h, made by Host/gestureExport. */
+#ifndef GLOVE_CLASSIFY
+#define GLOVE_CLASSIFY  0
+#endif
+#ifndef GLOVE_KEYFRAME_SWEEPS
+#define GLOVE_KEYFRAME_SWEEPS  250
+#endif
+
+/* Set GLOVE_DEADBAND to 1 in the makefile to only send the sensors that have
+ * moved by more than GLOVE_ACC_DEADBAND or GLOVE_BEND_DEADBAND counts since
+ * they were last sent (see deadband.h). A frame with all sensors is still sent
+ * every GLOVE_DEADBAND_KEY_SWEEPS sweeps or GLOVE_DEADBAND_KEY_MS ms. */
+#ifndef GLOVE_DEADBAND
+#define GLOVE_DEADBAND  0
+#endif
+#ifndef GLOVE_ACC_DEADBAND
+#define GLOVE_ACC_DEADBAND  4
+#endif
+#ifndef GLOVE_BEND_DEADBAND
+#define GLOVE_BEND_DEADBAND  2
+#endif
+#ifndef GLOVE_DEADBAND_KEY_SWEEPS
+#define GLOVE_DEADBAND_KEY_SWEEPS  50
+#endif
+#ifndef GLOVE_DEADBAND_KEY_MS
+#define GLOVE_DEADBAND_KEY_MS  1000
+#endif
+
+/* Set GLOVE_PACK to 1 in the makefile to compress the sweeps (see
+ * sweepCodec.h) and send as many of one type as fit in a packed frame (see
+ * gloveFrame.h). A packed frame is sent when it is full, or before its first
+ * sweep has waited more than GLOVE_PACK_LATENCY_MS ms, so a smaller budget
+ * gives quicker but more and emptier frames. Every GLOVE_PACK_KEY_SWEEPS-th
+ * sweep is a keyframe, from which the base station recovers after a lost
+ * frame. */
+#ifndef GLOVE_PACK
+#define GLOVE_PACK  0
+#endif
+#ifndef GLOVE_PACK_LATENCY_MS
+#define GLOVE_PACK_LATENCY_MS  50
+#endif
+#ifndef GLOVE_PACK_KEY_SWEEPS
+#define GLOVE_PACK_KEY_SWEEPS  25
+#endif
+#define PACK_LATENCY  (GLOVE_PACK_LATENCY_MS * (SAMPLER_TICKS_PER_SECOND / 1000))
+
+#if GLOVE_PACK
+#if GLOVE_DEADBAND
+#error "Use either GLOVE_PACK or GLOVE_DEADBAND"
+#endif
+#if GLOVE_PACK_LATENCY_MS > 65
+#error "GLOVE_PACK_LATENCY_MS must be at most 65, the sweep times in a packed frame are 16 bits"
+#endif
+#endif
+
+#if GLOVE_CLASSIFY
+#include "gestureModel.h"
+#if GESTURE_MODEL_COUNT > GESTURE_MAX_GESTURES || GESTURE_MODEL_VALUES != SWEEP_SAMPLES
+#error "gestureModel.h does not match gesture.h or the sweep size"
+#endif
+#endif
+
 static volatile rf_msgType receivedMsg;
 
-static uint8_t txBuffer[RF_MAX_PAYLOAD_SIZE];
+#ifdef RF_USE_TX_QUEUE
+/* Frames are filled in turn and queued with rf_sendAsync(). The radio holds at
+ * most RF_TX_QUEUE_SIZE of them, so the buffer after the newest is free. */
+#define FRAME_BUFFERS  (RF_TX_QUEUE_SIZE + 1)
+static uint8_t frameBuffers[FRAME_BUFFERS][RF_MAX_PAYLOAD_SIZE];
+static uint8_t* txBuffer = frameBuffers[0];
+static uint8_t frameIndex = 0;
+#if GLOVE_TDMA
+/* The heldFrames frames before frameIndex wait for the glove's slot, and the
+ * radioFrames frames before them are on the radio's queue, which is busy
+ * until radioEnd */
+static uint8_t frameLengths[FRAME_BUFFERS];
+static uint8_t heldFrames = 0;
+static volatile uint8_t radioFrames = 0;
+static uint32_t radioEnd;
+#endif
+#else
+/* One frame is filled while the other waits for, or is on, the radio */
+static uint8_t frameBuffers[2][RF_MAX_PAYLOAD_SIZE];
+static uint8_t* txBuffer = frameBuffers[0];
+static uint8_t* pendingFrame = NULL;
+static uint8_t pendingLength;
+#endif
 //static uint8_t i,j;
 static unsigned char i,j;
-static double tempresult;
-  uint8_t Bdata[25];
+static int16_t sweepSamples[SWEEP_SAMPLES];
+#if GLOVE_ACC_FIFO
+static uint8_t accFifo[16][ACC_FIFO_SAMPLES][6];
+#endif
+#if GLOVE_FILTER
+static int16_t accHistory[SWEEP_SAMPLES * GLOVE_FILTER_LENGTH];
+static int32_t accSums[SWEEP_SAMPLES];
+static boxcar_filterType accFilter;
+static int16_t bendHistory[SWEEP_SAMPLES * GLOVE_FILTER_LENGTH];
+static int32_t bendSums[SWEEP_SAMPLES];
+static boxcar_filterType bendFilter;
+#endif
+#if GLOVE_CLASSIFY
+static const gesture_modelType gestureModel = {gestureCentroids, GESTURE_MODEL_COUNT, GESTURE_MODEL_VALUES, GESTURE_MODEL_SHIFT};
+static gesture_voteType gestureVote;
+static uint8_t gesture = GESTURE_NONE;
+static uint8_t sentGesture = GESTURE_NONE;
+static uint16_t accSinceKeyframe = GLOVE_KEYFRAME_SWEEPS - 1;
+static uint16_t bendSinceKeyframe = GLOVE_KEYFRAME_SWEEPS - 1;
+static bool accSendRaw;
+static bool bendSendRaw;
+#endif
+#if GLOVE_DEADBAND
+static uint8_t accDeadbands[DEADBAND_CHANNELS];
+static deadband_stateType accDeadband;
+static uint8_t bendDeadbands[DEADBAND_CHANNELS];
+static deadband_stateType bendDeadband;
+#endif
+#if GLOVE_PACK
+/* Sweeps of one type waiting to be sent. length is 0 while there are none. */
+typedef struct
+{
+	uint8_t frame[RF_MAX_PAYLOAD_SIZE];
+	uint8_t length;
+	uint8_t seq;			/* Packed frames sent */
+	uint32_t first;			/* Sampler time of the first sweep */
+	uint32_t last;			/* Sampler time of the last sweep */
+	sweepCodec_stateType codec;
+} packType;
+static packType accPack;
+static packType bendPack;
+#endif
+#if GLOVE_RECEIVE
+static volatile uint8_t rxBuffer[RF_MAX_PAYLOAD_SIZE];
+#endif
+#if GLOVE_REMOTE_RATES
+/* Last rate frame received, rateType is 0 once it has been used */
+static volatile uint8_t rateType;
+static volatile uint16_t rateValue;
+#endif
+#if GLOVE_TDMA
+/* Last beacon received and when its SFD arrived (low 16 bits of the sampler
+ * time), isBeaconNew is cleared once it has been used */
+static volatile bool isBeaconNew = false;
+static volatile uint16_t beaconTime;
+static volatile uint16_t beaconSlotLength;
+static volatile uint8_t beaconSlotCount;
+static volatile uint8_t beaconSlot;
+/* Start of the glove's slot in one of the superframes, and the lengths of the
+ * slot and the superframe. slotLength is 0 while the glove has no slot. */
+static uint32_t slotStart;
+static uint16_t slotLength = 0;
+static uint16_t superframeLength;
+#endif
+#if GLOVE_TIME_SYNC
+/* Last sync or beacon frame received, with the base station time the frame
+ * before it was sent, and when its SFD arrived (low 16 bits of the sampler
+ * time). isSyncNew is cleared once it has been used */
+static volatile bool isSyncNew = false;
+static volatile uint16_t syncArrived;
+static volatile uint32_t syncTime;
+static volatile uint8_t syncSeq;
+static timeSync_stateType timeSync;
+static uint32_t lastSync;
+/* When the last frame used arrived, to pair with the time in the next */
+static bool isPreviousSync = false;
+static uint32_t previousSync;
+static uint8_t previousSyncSeq;
+#endif
+static uint8_t groups;
+static uint32_t accTime;
+static uint16_t accSpan;
+static uint8_t accSeq;
+static uint32_t bendTime;
+static volatile uint16_t bendSpan;
+static uint8_t bendSeq;
+static uint16_t bendData[SWEEP_SAMPLES + 1];
+static adc_ringType bendRing = {bendData, SWEEP_SAMPLES + 1, 0, 0, 0};
+static uint8_t bendSettle[SWEEP_SAMPLES];
+static uint16_t settleSweeps = 0;
+static int8_t accOffsets[16][3];
+static bool accOffsetsValid;
+static const uint8_t muxBits[GLOVESENSORS_POSITIONS] = {GLOVESENSORS_MAP(GLOVESENSORS_MUX_ENTRY)};
+static void bendStep(uint8_t step);
+static adc_scanType bendScan = {bendChannels, BEND_CHANNELS, 16, bendStep, bendSettle, true};
   uint16_t adcValue;
-  
-  //---------*********TIMER**********-----------
-  
-// these values are changed in an ISR, so they must be declared as volatile
-volatile uint8_t timer0_ticks;
-volatile uint16_t overflowCount;
-  
-
-/********************************************************************************
-Interrupt Routines
-********************************************************************************/
-
-// timer1 overflow
-ISR(TIMER1_OVF_vect) {
-   // printf("***** Timer1 Overflow *****\n");
+
+/*------------------------------------------------------------------------------
+ * Move the bend mux to the next position, called by the ADC scan.
+ */
+static void bendStep(uint8_t step)
+{
+	/* The last mux position is reached, see gloveFrame.h for the span */
+	if(step == 15)bendSpan = sampler_getTimeLow() - (uint16_t)bendTime;
+	uc_sw_MUX_BEND_EN_HI;//Disconnect interface
+	GLOVESENSORS_SET_MUX(muxBits[step]);
+	uc_sw_MUX_BEND_EN_LO;//Interface Enabled
 }
-// timer0 overflow
-ISR(TIMER0_OVF_vect) {
-    // 61 ticks = 2 seconds @ 8.0MHz
-    timer0_ticks++;
-	//printf("Its been %u ticks.\n",timer0_ticks);
-    if(timer0_ticks < 10){
-        //fake it 
-    }
-    if(timer0_ticks==61){
-        timer0_ticks = 0;
-        // till you make it, now we increment seconds twice
-		if(overflowCount >= 100){
-			overflowCount = 0;
-		}else{
-			overflowCount++;
-		}
-       // printf("Its been %u seconds.\n",seconds);
-    }
+
+/*------------------------------------------------------------------------------
+ * Send the pending frame if the radio has finished the previous one. With
+ * GLOVE_TDMA, queue the waiting frames that fit in what is left of the slot.
+ */
+static void sendPending(void)
+{
+#if GLOVE_TDMA
+	uint32_t now;
+	uint32_t elapsed;
+	uint32_t end;
+	uint8_t index;
+	uint16_t airTime;
+
+	if(heldFrames == 0 || slotLength == 0)return;
+	now = sampler_getTime();
+	elapsed = (now - slotStart) % superframeLength;
+	end = ((int32_t)(radioEnd - now) > 0) ? radioEnd : now;
+	while(heldFrames != 0)
+	{
+		index = (frameIndex + FRAME_BUFFERS - heldFrames) % FRAME_BUFFERS;
+		airTime = RF_TX_TURNAROUND_US + RF_AIR_TIME_US(frameLengths[index]);
+		if(elapsed + (end - now) + airTime + GLOVE_TDMA_GUARD > slotLength)break;
+		if(rf_sendAsync(DEST_ADDR, frameBuffers[index], frameLengths[index]) != STATUS_OK)break;
+		disableInterrupts();
+		radioFrames++;
+		enableInterrupts();
+		heldFrames--;
+		end += airTime;
+	}
+	radioEnd = end;
+#elif !defined(RF_USE_TX_QUEUE)
+	if(pendingFrame != NULL && !rf_isBusy())
+	{
+		rf_send(DEST_ADDR, pendingFrame, pendingLength);
+		pendingFrame = NULL;
+	}
+#endif
 }
 
+/*------------------------------------------------------------------------------
+ * Copy the values in txBuffer to an array.
+ */
+static void getFrameValues(int16_t* values)
+{
+	uint8_t n;
 
+	for(n=0;n<SWEEP_SAMPLES;n++)
+	values[n]=gloveFrame_getValue(txBuffer,n);
+}
 
-  //---------*********TIMER**********-----------
+#if GLOVE_FILTER
+/*------------------------------------------------------------------------------
+ * Pass the values in txBuffer through a filter. Returns true if the averages
+ * have been written back to txBuffer and should be sent.
+ */
+static bool filterFrame(boxcar_filterType* filter)
+{
+	int16_t values[SWEEP_SAMPLES];
+	uint8_t n;
+
+	getFrameValues(values);
+	if(!boxcar_add(filter,values,values))return false;
+	for(n=0;n<SWEEP_SAMPLES;n++)
+	gloveFrame_setValue(txBuffer,n,values[n]);
+	return true;
+}
+
+#endif
+/*------------------------------------------------------------------------------
+ * Queue the frame in txBuffer for the radio and start filling the next
+ * buffer. If the radio's queue is full (or, without RF_USE_TX_QUEUE, the
+ * previous frame has still not been sent), this waits for it. With
+ * GLOVE_TDMA the frame waits for the slot instead, or is dropped if the next
+ * buffer is not free.
+ */
+static void queueBuffer(uint8_t length)
+{
+#if GLOVE_TDMA
+	if(heldFrames + radioFrames + 1 >= FRAME_BUFFERS)return;
+	frameLengths[frameIndex] = length;
+	heldFrames++;
+	frameIndex = (frameIndex + 1) % FRAME_BUFFERS;
+	txBuffer = frameBuffers[frameIndex];
+	sendPending();
+#elif defined(RF_USE_TX_QUEUE)
+	while(rf_sendAsync(DEST_ADDR, txBuffer, length) == STATUS_COMM_ERROR)
+	{
+		;
+	}
+	frameIndex = (frameIndex + 1) % FRAME_BUFFERS;
+	txBuffer = frameBuffers[frameIndex];
+#else
+	if(pendingFrame != NULL)
+	{
+		rf_send(DEST_ADDR, pendingFrame, pendingLength);
+	}
+	pendingFrame = txBuffer;
+	pendingLength = length;
+	txBuffer = (txBuffer == frameBuffers[0]) ? frameBuffers[1] : frameBuffers[0];
+	sendPending();
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * Time to put in a frame for a sampler time.
+ */
+static uint32_t frameTime(uint32_t time)
+{
+#if GLOVE_TIME_SYNC
+	return timeSync_toGlobal(&timeSync,time);
+#else
+	return time;
+#endif
+}
+
+#if GLOVE_PACK
+/*------------------------------------------------------------------------------
+ * Queue a packed frame, if it has any sweeps. This uses txBuffer.
+ */
+static void flushPack(packType* pack)
+{
+	uint8_t n;
+
+	if(pack->length == 0)return;
+	for(n=0;n<pack->length;n++)
+	txBuffer[n]=pack->frame[n];
+	queueBuffer(pack->length);
+	pack->length = 0;
+	pack->seq++;
+}
+
+/*------------------------------------------------------------------------------
+ * Queue a packed frame if its first sweep has used up the latency budget.
+ */
+static void flushStale(packType* pack)
+{
+	if(pack->length != 0 && sampler_getTime() - pack->first > PACK_LATENCY)flushPack(pack);
+}
+
+/*------------------------------------------------------------------------------
+ * Compress the values in txBuffer and add them to a packed frame, sending the
+ * frame first if they don't fit. A sweep too big for a packed frame of its own
+ * is sent as it is, and the codec starts again from a keyframe.
+ */
+static void packSweep(packType* pack, uint8_t type, uint8_t seq, uint32_t time, uint16_t span)
+{
+	int16_t values[SWEEP_SAMPLES];
+	uint8_t block[SWEEPCODEC_MAX_SIZE(SWEEP_SAMPLES)];
+	uint8_t size;
+	uint8_t length = 0;
+	uint32_t interval;
+
+	getFrameValues(values);
+	size = sweepCodec_encode(&pack->codec,values,block);
+	if(pack->length != 0)
+	{
+		length = gloveFrame_addSweep(pack->frame,pack->length,RF_MAX_PAYLOAD_SIZE,seq,frameTime(time),span,block,size);
+		if(length == 0)flushPack(pack);
+	}
+	if(length == 0)
+	{
+		pack->first = time;
+		gloveFrame_writePacked(pack->frame,type,pack->seq,frameTime(time));
+		length = gloveFrame_addSweep(pack->frame,GLOVEFRAME_PACKED_SIZE,RF_MAX_PAYLOAD_SIZE,seq,frameTime(time),span,block,size);
+	}
+	if(length == 0)
+	{
+		sweepCodec_reset(&pack->codec);
+		gloveFrame_encode(txBuffer,type,seq,frameTime(time),span,GLOVEFRAME_ALL_CHANNELS,values);
+		queueBuffer(FRAME_LENGTH);
+		return;
+	}
+	pack->length = length;
+
+	/* Send now if the next sweep would arrive after the latency budget */
+	interval = (pack->last != 0) ? time - pack->last : 0;
+	pack->last = time;
+	if(time - pack->first + interval > PACK_LATENCY)flushPack(pack);
+}
+
+#endif
+/*------------------------------------------------------------------------------
+ * Write the frame header to txBuffer and queue it. With GLOVE_FILTER, the frame
+ * is only queued when the filter outputs an average, and with GLOVE_CLASSIFY
+ * only on keyframe sweeps. With GLOVE_DEADBAND, only the sensors that have
+ * changed are kept, and nothing is queued if none have. With GLOVE_PACK, the
+ * sweep is added to a packed frame. Otherwise txBuffer is reused for the next
+ * frame.
+ */
+static void queueFrame(uint8_t type, uint32_t time)
+{
+#if GLOVE_DEADBAND
+	int16_t values[SWEEP_SAMPLES];
+	uint16_t mask;
+#endif
+
+#if GLOVE_FILTER
+	if(!filterFrame(type == GLOVEFRAME_TYPE_ACC ? &accFilter : &bendFilter))return;
+#endif
+#if GLOVE_CLASSIFY
+	if(!(type == GLOVEFRAME_TYPE_ACC ? accSendRaw : bendSendRaw))return;
+#endif
+	if(type == GLOVEFRAME_TYPE_ACC)
+	gloveFrame_writeHeader(txBuffer,type,accSeq,frameTime(time),accSpan,GLOVEFRAME_ALL_CHANNELS);
+	else
+	gloveFrame_writeHeader(txBuffer,type,bendSeq,frameTime(time),bendSpan,GLOVEFRAME_ALL_CHANNELS);
+#if GLOVE_PACK
+	if(type == GLOVEFRAME_TYPE_ACC)packSweep(&accPack,type,accSeq,time,accSpan);
+	else packSweep(&bendPack,type,bendSeq,time,bendSpan);
+#elif GLOVE_DEADBAND
+	getFrameValues(values);
+	mask = deadband_select(type == GLOVEFRAME_TYPE_ACC ? &accDeadband : &bendDeadband,values,time);
+	if(mask == 0)return;
+	queueBuffer(gloveFrame_compact(txBuffer,mask));
+#else
+	queueBuffer(FRAME_LENGTH);
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * Queue a settle frame if one is due. This uses txBuffer, so any frame in it
+ * must have been queued first.
+ */
+static void queueSettle(void)
+{
+	if(settleSweeps-- != 0)return;
+	settleSweeps = GLOVE_SETTLE_SWEEPS - 1;
+	queueBuffer(gloveFrame_writeSettle(txBuffer,bendSeq,frameTime(bendTime),bendSettle));
+}
+
+#if GLOVE_CLASSIFY
+/*------------------------------------------------------------------------------
+ * Count a sweep, and return true if it is a keyframe.
+ */
+static bool isKeyframe(uint16_t* sinceKeyframe)
+{
+	if(++(*sinceKeyframe) < GLOVE_KEYFRAME_SWEEPS)return false;
+	*sinceKeyframe = 0;
+	return true;
+}
+
+/*------------------------------------------------------------------------------
+ * Classify the accelerometer values in txBuffer, and decide whether this sweep
+ * is a keyframe.
+ */
+static void classifySweep(void)
+{
+	int16_t values[SWEEP_SAMPLES];
+
+	getFrameValues(values);
+	gesture = gesture_vote(&gestureVote,gesture_classify(&gestureModel,values));
+	accSendRaw = isKeyframe(&accSinceKeyframe);
+}
+
+/*------------------------------------------------------------------------------
+ * Queue a gesture frame if the recognised gesture has changed. This uses
+ * txBuffer, so any frame in it must have been queued first.
+ */
+static void queueGesture(void)
+{
+	if(gesture == sentGesture)return;
+	sentGesture = gesture;
+	queueBuffer(gloveFrame_writeGesture(txBuffer,accSeq,frameTime(accTime),gesture));
+}
+
+#endif
+#if GLOVE_REMOTE_RATES
+/*------------------------------------------------------------------------------
+ * Change a sweep rate if a rate frame has been received.
+ */
+static void applyRate(void)
+{
+	uint8_t type;
+	uint16_t rate;
+
+	disableInterrupts();
+	type = rateType;
+	rate = rateValue;
+	rateType = 0;
+	enableInterrupts();
+
+	if(type == GLOVEFRAME_TYPE_ACC)sampler_setGroupRate(ACC_GROUP,rate);
+	else if(type == GLOVEFRAME_TYPE_BEND)sampler_setGroupRate(BEND_GROUP,rate);
+}
+
+#endif
+#if GLOVE_TDMA
+/*------------------------------------------------------------------------------
+ * Line the slot and the sweeps up with the superframe if a beacon has been
+ * received. This must run within 65ms of the beacon arriving.
+ */
+static void applyBeacon(void)
+{
+	uint16_t arrived;
+	uint16_t length;
+	uint8_t count;
+	uint8_t slot;
+	uint32_t superframe;
+	uint32_t now;
+
+	disableInterrupts();
+	if(!isBeaconNew)
+	{
+		enableInterrupts();
+		return;
+	}
+	isBeaconNew = false;
+	arrived = beaconTime;
+	length = beaconSlotLength;
+	count = beaconSlotCount;
+	slot = beaconSlot;
+	enableInterrupts();
+
+	/* The beacon's own slot and the count slots after it */
+	superframe = (uint32_t)(count + 1) * length;
+	if(slot == GLOVEFRAME_NO_SLOT || length == 0 || superframe > 0xFFFF)
+	{
+		slotLength = 0;
+		sampler_setGroupRate(SLOT_GROUP,0);
+		return;
+	}
+	now = sampler_getTime();
+	slotStart = now - (uint16_t)((uint16_t)now - arrived) + (uint32_t)slot * length;
+	slotLength = length;
+	superframeLength = superframe;
+	sampler_alignGroup(SLOT_GROUP,slotStart,superframeLength);
+	sampler_alignGroup(ACC_GROUP,slotStart - GLOVE_TDMA_LEAD,superframeLength);
+	sampler_alignGroup(BEND_GROUP,slotStart - GLOVE_TDMA_LEAD,superframeLength);
+}
+
+#endif
+#if GLOVE_TIME_SYNC
+/*------------------------------------------------------------------------------
+ * Add the last base station time received to the clock fit, if
+ * GLOVE_SYNC_INTERVAL_MS have passed since the last one used. The time in a
+ * frame is when the frame before it was sent, so it is paired with when that
+ * frame arrived. This must run within 65ms of the frame arriving.
+ */
+static void applySync(void)
+{
+	uint16_t arrived;
+	uint32_t time;
+	uint32_t local;
+	uint32_t previous;
+	uint8_t seq;
+	bool isPair;
+
+	disableInterrupts();
+	if(!isSyncNew)
+	{
+		enableInterrupts();
+		return;
+	}
+	isSyncNew = false;
+	arrived = syncArrived;
+	time = syncTime;
+	seq = syncSeq;
+	enableInterrupts();
+
+	local = sampler_getTime();
+	local -= (uint16_t)((uint16_t)local - arrived);
+	isPair = isPreviousSync && seq == (uint8_t)(previousSyncSeq + 1);
+	previous = previousSync;
+	isPreviousSync = true;
+	previousSync = local;
+	previousSyncSeq = seq;
+	if(!isPair)return;
+
+	if(timeSync.count != 0 && previous - lastSync < GLOVE_SYNC_INTERVAL_MS * (SAMPLER_TICKS_PER_SECOND / 1000))return;
+	lastSync = previous;
+	/* Either clock has jumped (e.g. the base station restarted) or the pair is
+	 * wrong, so start again from the next pair rather than from this one */
+	if(timeSync_add(&timeSync,previous,time) != STATUS_OK)timeSync_init(&timeSync);
+}
+
+#endif
+
+#if GLOVE_ACC_FIFO
+/*------------------------------------------------------------------------------
+ * Read the newest ACC_FIFO_SAMPLES samples from the FIFO of the selected
+ * accelerometer into accFifo[acc], oldest first.
+ */
+static void readAccFifo(uint8_t acc)
+{
+	uint8_t entries,n;
+
+	/* The ADXL345 clocks are not exact, so drop any extra samples rather than
+	 * fall further behind */
+	entries = adxl345_spi_fifoEntries();
+	while(entries > ACC_FIFO_SAMPLES)
+	{
+		adxl345_spi_readFifo(accFifo[acc][0],1);
+		entries--;
+	}
+
+	if(entries == 0)
+	{
+		/* Nothing new, keep the newest sample of the last sweep */
+		n = ACC_FIFO_SAMPLES - 1;
+	}
+	else
+	{
+		n = ACC_FIFO_SAMPLES - entries;
+		adxl345_spi_readFifo(accFifo[acc][n],entries);
+	}
+
+	/* Repeat the oldest sample read for any that are missing */
+	while(n--)
+	{
+		for(entries=0;entries<6;entries++)
+		accFifo[acc][n][entries]=accFifo[acc][n+1][entries];
+	}
+}
+
+/*------------------------------------------------------------------------------
+ * Queue a frame for each FIFO sample of the sweep at time, oldest first.
+ * txBuffer already holds the oldest.
+ */
+static void queueAccFifo(uint32_t time)
+{
+	uint8_t sample,acc,n;
+
+	queueFrame(GLOVEFRAME_TYPE_ACC,time-(ACC_FIFO_SAMPLES-1)*ACC_PERIOD);
+	for(sample=1;sample<ACC_FIFO_SAMPLES;sample++)
+	{
+		for(acc=0;acc<16;acc++)
+		for(n=0;n<6;n++)
+		txBuffer[GLOVEFRAME_VALUE_OFFSET(3*acc)+n]=accFifo[acc][sample][n];
+		queueFrame(GLOVEFRAME_TYPE_ACC,time-(ACC_FIFO_SAMPLES-1-sample)*ACC_PERIOD);
+	}
+}
+
+#endif
+/*------------------------------------------------------------------------------
+ * Read one accelerometer into txBuffer. This is called once for each sensor by
+ * READ_ACC, with constants, so selecting it is a single write to PORTC.
+ */
+static inline void readAcc(uint8_t acc, uint8_t bits)
+{
+#if GLOVE_ACC_FIFO
+	uint8_t n;
+#endif
+
+	GLOVESENSORS_SET_MUX(bits);
+	delay_us(2);
+	uc_sw_MUX_ACC_EN_LO;//Connect interface
+	delay_us(2);
+	if(acc==GLOVESENSORS_POSITIONS-1)accSpan=sampler_getTimeLow()-(uint16_t)accTime;
+#if GLOVE_ACC_FIFO
+	readAccFifo(acc);
+	for(n=0;n<6;n++)
+	txBuffer[GLOVEFRAME_VALUE_OFFSET(3*acc)+n]=accFifo[acc][0][n];
+#else
+	//DATAX0 to DATAZ1 in one transfer
+	adxl345_spi_readMultiple(REG_ADDR_ADXL345_DATA_X0,&txBuffer[GLOVEFRAME_VALUE_OFFSET(3*acc)],6);
+#endif
+	uc_sw_MUX_ACC_EN_HI;//Disconnect interface
+}
+#define READ_ACC(mux, ...)  readAcc(mux, GLOVESENSORS_MUX_BITS(mux));
+
+/*------------------------------------------------------------------------------
+ * Load the bend settle table from EEPROM, or use the defaults if it has not
+ * been saved. If GLOVE_CALIBRATE_SETTLE is defined, the shortest settling
+ * times are found (the hand should be kept still) and saved instead.
+ */
+static void loadBendSettle(void)
+{
+	uint8_t marker[2];
+	uint8_t k;
+
+	eeprom_mcu_read(marker, SETTLE_EEPROM_START, SETTLE_EEPROM_START + 1);
+	if(marker[0] == SETTLE_EEPROM_MARKER && marker[1] == SWEEP_SAMPLES)
+	{
+		eeprom_mcu_read(bendSettle, SETTLE_EEPROM_START + 2,
+				SETTLE_EEPROM_START + 1 + SWEEP_SAMPLES);
+	}
+	else
+	{
+		for(k=0;k<SWEEP_SAMPLES;k++)
+		bendSettle[k] = (k % BEND_CHANNELS == 0) ? BEND_SETTLE : 0;
+	}
+
+#ifdef GLOVE_CALIBRATE_SETTLE
+	{
+		uint16_t reference[SWEEP_SAMPLES];
+
+		adc_calibrateScan(&bendScan, &bendRing, reference, BEND_SETTLE_MAX, BEND_SETTLE_TOLERANCE);
+		uc_sw_MUX_BEND_EN_HI;//Disconnect interface
+
+		marker[0] = SETTLE_EEPROM_MARKER;
+		marker[1] = SWEEP_SAMPLES;
+		eeprom_mcu_write(marker, SETTLE_EEPROM_START, SETTLE_EEPROM_START + 1);
+		eeprom_mcu_write(bendSettle, SETTLE_EEPROM_START + 2,
+				SETTLE_EEPROM_START + 1 + SWEEP_SAMPLES);
+	}
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * Load the accelerometer offsets from EEPROM. accOffsetsValid is left false
+ * if they have not been saved, and the ADXL345s keep their own (zero) offsets.
+ */
+static void loadAccOffsets(void)
+{
+	uint8_t marker[2];
+
+	eeprom_mcu_read(marker, OFFSET_EEPROM_START, OFFSET_EEPROM_START + 1);
+	accOffsetsValid = (marker[0] == OFFSET_EEPROM_MARKER && marker[1] == SWEEP_SAMPLES);
+	if(accOffsetsValid)
+	{
+		eeprom_mcu_read((uint8_t*)accOffsets, OFFSET_EEPROM_START + 2,
+				OFFSET_EEPROM_START + 1 + SWEEP_SAMPLES);
+	}
+}
+
+#ifdef GLOVE_CALIBRATE_OFFSETS
+/*------------------------------------------------------------------------------
+ * Save the accelerometer offsets found by adxl345_spi_calibrateOffsets().
+ */
+static void saveAccOffsets(void)
+{
+	uint8_t marker[2];
+
+	marker[0] = OFFSET_EEPROM_MARKER;
+	marker[1] = SWEEP_SAMPLES;
+	eeprom_mcu_write((uint8_t*)accOffsets, OFFSET_EEPROM_START + 2,
+			OFFSET_EEPROM_START + 1 + SWEEP_SAMPLES);
+	eeprom_mcu_write(marker, OFFSET_EEPROM_START, OFFSET_EEPROM_START + 1);
+	accOffsetsValid = true;
+}
+#endif
 
 int main(void)
 {
@@ -188,21 +1056,8 @@ int main(void)
 	sensor_OUT;
     sensor_off;
 	
-	  //---------*********TIMER**********-----------
-    // enable timer overflow interrupt for both Timer0 and Timer1
-    TIMSK=(1<<TOIE0) | (1<<TOIE1);
-
-    // set timer0 counter initial value to 0
-    TCNT0=0x00;
-    // start timer0 with /1024 prescaler
-    TCCR0 = (1<<CS02) | (1<<CS00);
-    // lets turn on 16 bit timer1 also
-    TCCR1B |= (1 << CS10) | (1 << CS12);
-
-    // enable interrupts
+    // enable interrupts (sweeps are timed by sampler_avr.c on Timer1)
     sei(); 
-	
-	  //---------*********TIMER**********-----------
 
 	
 	
@@ -233,87 +1088,127 @@ int main(void)
     DDRF  = 0x00;
 	rf_init(RF_CHANNEL_CENTRE, RF_PWR_MAX);
 	rf_setReceiveBuffer(&receivedMsg);
+#if GLOVE_RECEIVE
+	receivedMsg.data = rxBuffer;
+	rf_setMode(RF_MODE_RECEIVING);
+#else
 	//rf_setMode(RF_MODE_RECEIVING);
+	/* Keep the oscillator on, so rf_send() returns when the transmission
+	 * starts instead of waiting for it to finish to go back to sleep, and
+	 * rf_sendAsync() does not sleep between frames */
+	rf_setMode(RF_MODE_STANDBY);
+#endif
 	sensor_on;
 	uart_init();
+	adc_init(ADC_CH_ADC2, ADC_BITS_10, ADC_REF_VCC);
 
 
 	uc_sw_MUX_ACC_EN_LO;
 	delay_us(500);
+	loadAccOffsets();
 	
 for(j=0;j<16;j++)
 {
 
 
-	if(j&0x01)uc_sw_MUX_A0_HI;
-	else uc_sw_MUX_A0_LO;
-	if(j&0x02)uc_sw_MUX_A1_HI;
-	else uc_sw_MUX_A1_LO;
-	if(j&0x04)uc_sw_MUX_A2_HI;
-	else uc_sw_MUX_A2_LO;
-	if(j&0x08)uc_sw_MUX_A3_HI;
-	else uc_sw_MUX_A3_LO;
+	GLOVESENSORS_SET_MUX(muxBits[j]);
 	delay_us(100);
 	adxl345_spi_write(0x31,0x08);
 	adxl345_spi_write(0x31,0x08);	
 	
 	adxl345_spi_write(0x2D,0x08);		// start measurement
 	adxl345_spi_write(0x31,0x08);
+#ifdef GLOVE_CALIBRATE_OFFSETS
+	adxl345_spi_calibrateOffsets(accOffsets[j],ACC_OFFSET_SAMPLES);
+#else
+	if(accOffsetsValid)
+	adxl345_spi_setOffsets(accOffsets[j]);
+#endif
+#if GLOVE_ACC_FIFO
+	adxl345_spi_startFifo(ACC_RATE_CODE,ACC_FIFO_SAMPLES,false);
+#endif
+	}
+	uc_sw_MUX_ACC_EN_HI;//Disconnect interface
+#ifdef GLOVE_CALIBRATE_OFFSETS
+	saveAccOffsets();
+#endif
+	loadBendSettle();
+#if GLOVE_CLASSIFY
+	gesture_voteInit(&gestureVote);
+#endif
+#if GLOVE_DEADBAND
+	for(j=0;j<DEADBAND_CHANNELS;j++)
+	{
+		accDeadbands[j] = GLOVE_ACC_DEADBAND;
+		bendDeadbands[j] = GLOVE_BEND_DEADBAND;
 	}
+	deadband_init(&accDeadband,accDeadbands,GLOVE_DEADBAND_KEY_SWEEPS,GLOVE_DEADBAND_KEY_MS * (SAMPLER_TICKS_PER_SECOND / 1000));
+	deadband_init(&bendDeadband,bendDeadbands,GLOVE_DEADBAND_KEY_SWEEPS,GLOVE_DEADBAND_KEY_MS * (SAMPLER_TICKS_PER_SECOND / 1000));
+#endif
+#if GLOVE_TIME_SYNC
+	timeSync_init(&timeSync);
+#endif
+#if GLOVE_PACK
+	sweepCodec_init(&accPack.codec,SWEEP_SAMPLES,GLOVE_PACK_KEY_SWEEPS);
+	sweepCodec_init(&bendPack.codec,SWEEP_SAMPLES,GLOVE_PACK_KEY_SWEEPS);
+#endif
+#if GLOVE_FILTER
+	boxcar_init(&accFilter,accHistory,accSums,SWEEP_SAMPLES,GLOVE_FILTER_LENGTH,GLOVE_FILTER_DECIMATION,0);
+	boxcar_init(&bendFilter,bendHistory,bendSums,SWEEP_SAMPLES,GLOVE_FILTER_LENGTH,GLOVE_FILTER_DECIMATION,0);
+#endif
+
+	/* Sweep the accelerometers every 1/GLOVE_ACC_SWEEP_RATE seconds, and the
+	 * bend sensors every 1/GLOVE_BEND_SWEEP_RATE seconds */
+	sampler_init(GLOVE_ACC_SWEEP_RATE);
+	sampler_setGroupRate(BEND_GROUP,GLOVE_BEND_SWEEP_RATE);
     for (;;) {
+		groups = sampler_waitGroups();
+#if GLOVE_TDMA
+		applyBeacon();
+#endif
+#if GLOVE_TIME_SYNC
+		applySync();
+#endif
+		sendPending();
+#if GLOVE_PACK
+		flushStale(&accPack);
+		flushStale(&bendPack);
+#endif
+#if GLOVE_REMOTE_RATES
+		applyRate();
+#endif
 	
 		uc_sw_MUX_BEND_EN_HI;//Interface Disabled
 		uc_sw_MUX_ACC_EN_HI;//Disconnect interface
 	
 		
 	//read accelerometers s
-	printf("%u.%.2u,",overflowCount,timer0_ticks);
+	if(groups & BIT(ACC_GROUP))
+	{
+	accTime = sampler_getTime();
+		/* One readAcc() for each accelerometer, with its mux bits as a
+		 * constant */
+		GLOVESENSORS_MAP(READ_ACC)
+	if(DEBUGGING_ON && !DEBUGGING_BINARY)
+	{
+		/* Time in seconds, wrapping after about 35 minutes */
+		fixedPoint_put((int32_t)(accTime & 0x7FFFFFFFUL),6);
+		putchar(',');
+	}
 		for(j=0;j<16;j++)
 		{
-			if(j&0x01)uc_sw_MUX_A0_HI;
-			else uc_sw_MUX_A0_LO;
-			if(j&0x02)uc_sw_MUX_A1_HI;
-			else uc_sw_MUX_A1_LO;
-			if(j&0x04)uc_sw_MUX_A2_HI;
-			else uc_sw_MUX_A2_LO;
-			if(j&0x08)uc_sw_MUX_A3_HI;
-			else uc_sw_MUX_A3_LO;
-			delay_us(2);
-			uc_sw_MUX_ACC_EN_LO;//Connect interface
-			delay_us(2);
-			
-			
-		txBuffer[0+6*j+3] = adxl345_spi_read(0xB2);
-		txBuffer[1+6*j+3] = adxl345_spi_read(0xB3);	
-        txBuffer[2+6*j+3] = adxl345_spi_read(0xB4);
-        txBuffer[3+6*j+3] = adxl345_spi_read(0xB5);
-        txBuffer[4+6*j+3] = adxl345_spi_read(0xB6);
-        txBuffer[5+6*j+3] = adxl345_spi_read(0xB7);
-		uc_sw_MUX_ACC_EN_HI;//Disconnect interface
-		if(DEBUGGING_ON)
+		if(DEBUGGING_ON && DEBUGGING_BINARY)
+		{
+			for (i=0;i<3;i++)
+			sweepSamples[3*j+i]=gloveFrame_getValue(txBuffer,3*j+i);
+		}
+		else if(DEBUGGING_ON)
 		{
 				for (i=0;i<3;i++)
 		{
 		
-		if(0x80&txBuffer[1+2*i+6*j+3])tempresult=((((txBuffer[0+2*i+6*j+3])^0xFF)+1)+256*((((txBuffer[2*i+1+6*j+3])^0xFF))))*(-1.0/256);
-		else tempresult=(txBuffer[2*i+6*j+3]+256*(txBuffer[2*i+1+6*j+3]))*(1.0/256);
-		snprintf(&Bdata[0],9,"%f",tempresult);
-			//putchar(' ');
-			//putchar('A');
-			//putchar('C');
-			//putchar('C');
-			//putHex_JT(j);
-			//putchar(' ');
-			//putchar(' ');
-			putchar(Bdata[0]);
-			putchar(Bdata[1]);
-			putchar(Bdata[2]);
-			putchar(Bdata[3]);
-			putchar(Bdata[4]);	
-			putchar(Bdata[5]);
-			putchar(Bdata[6]);
-			putchar(Bdata[7]);
-			putchar(Bdata[8]);
+		/* g, to the nearest milli-g */
+		fixedPoint_put(fixedPoint_accToMilliG(gloveFrame_getValue(txBuffer,3*j+i)),3);
 			putchar(',');
 
 
@@ -321,95 +1216,68 @@ for(j=0;j<16;j++)
 		}
 		}
 		}
-				if(DEBUGGING_ON)
+	}
+		/* Convert the bend sensors from the ADC interrupt while the
+		 * accelerometer data is being sent */
+		if(groups & BIT(BEND_GROUP))
+		{
+			bendTime = sampler_getTime();
+			adc_startScan(&bendScan,&bendRing);
+		}
+	if(groups & BIT(ACC_GROUP))
+	{
+				if(DEBUGGING_ON && DEBUGGING_BINARY)
 		{
+			uartFrame_send(UARTFRAME_TYPE_ACC,accSeq,accTime,sweepSamples,SWEEP_SAMPLES);
 		}
-		rf_send(DEST_ADDR, txBuffer, 99);
-		//delay_ms(7);
-		//rf_send(DEST_ADDR, txBuffer, 99);
+#if GLOVE_CLASSIFY
+		classifySweep();
+#endif
+#if GLOVE_ACC_FIFO
+		queueAccFifo(accTime);
+#else
+		queueFrame(GLOVEFRAME_TYPE_ACC,accTime);
+#endif
+#if GLOVE_CLASSIFY
+		queueGesture();
+#endif
+		accSeq++;
+	}
 		
-	
+		if(!(groups & BIT(BEND_GROUP)))continue;
+		while(adc_isScanning())sendPending();
+		uc_sw_MUX_BEND_EN_HI;//Disconnect interface
 			
 		for(j=0;j<16;j++)
 		{
-			if(j&0x01)uc_sw_MUX_A0_HI;
-			else uc_sw_MUX_A0_LO;
-			if(j&0x02)uc_sw_MUX_A1_HI;
-			else uc_sw_MUX_A1_LO;
-			if(j&0x04)uc_sw_MUX_A2_HI;
-			else uc_sw_MUX_A2_LO;
-			if(j&0x08)uc_sw_MUX_A3_HI;
-			else uc_sw_MUX_A3_LO;
-			delay_us(10);
-			uc_sw_MUX_BEND_EN_LO;//Interface Enabled
-			delay_us(90);
-			delay_us(250);
-			delay_us(250);
-			
-			adc_init(2, 10, ADC_REF_VCC);
-			
-			adcValue=adc_singleConversion();
-			//adcValue=adc_singleConversion();
-			txBuffer[0+6*j+3] = HIGH_BYTE(adcValue);
-			txBuffer[1+6*j+3]= LOW_BYTE(adcValue);
-			
-			
-			adc_init(1, 10,ADC_REF_VCC);
-			//delay_us(10);
-			adcValue=adc_singleConversion();
-			//adcValue=adc_singleConversion();
-			txBuffer[2+6*j+3] = HIGH_BYTE(adcValue);
-			txBuffer[3+6*j+3] = LOW_BYTE(adcValue);
-			
-			adc_init(3, 10,ADC_REF_VCC);
-			//adc_init(3, 10,ADC_REF_INTERNAL);
-			//delay_us(100);
-			adcValue=adc_singleConversion();
-
-			//adcValue=adc_singleConversion();
-			txBuffer[4+6*j+3] = HIGH_BYTE(adcValue);
-			txBuffer[5+6*j+3]  = LOW_BYTE(adcValue);
-
+			for (i=0;i<BEND_CHANNELS;i++)
+			{
+				adc_ringRead(&bendRing,&adcValue);
+				gloveFrame_setValue(txBuffer,3*j+i,adcValue);
+			}
 			
-		uc_sw_MUX_BEND_EN_HI;//Disconnect interface
-		if(DEBUGGING_ON)
+		if(DEBUGGING_ON && DEBUGGING_BINARY)
+		{
+			for (i=0;i<3;i++)
+			sweepSamples[3*j+i]=gloveFrame_getValue(txBuffer,3*j+i);
+		}
+		else if(DEBUGGING_ON)
 		{
 			for (i=0;i<1;i++)
 		{
 		
 
-		tempresult=(txBuffer[2*i+1+6*j+3]+256*((txBuffer[2*i+6*j+3])&0x03))*(3.3/1024);
-		snprintf(&Bdata[0],9,"%f",tempresult);
-			
-			
-			
+		/* Volts, to the nearest millivolt */
+		if(i==0 && j <= 5)
+		fixedPoint_put(fixedPoint_adcToMilliVolts(gloveFrame_getValue(txBuffer,3*j+i)&GLOVESENSORS_BEND_MASK,GLOVESENSORS_BEND_REF_MV,GLOVESENSORS_BEND_BITS),3);
 			
 			if(i==0 && j < 5)
 			{
-				
-				putchar(Bdata[0]);
-				putchar(Bdata[1]);
-				putchar(Bdata[2]);
-				putchar(Bdata[3]);
-				putchar(Bdata[4]);
-				putchar(Bdata[5]);
-				putchar(Bdata[6]);
-				putchar(Bdata[7]);
-				putchar(Bdata[8]);
 				putchar(',');
 				
 			
 			} else if(i==0 && j == 5){
 			
-				putchar(Bdata[0]);
-				putchar(Bdata[1]);
-				putchar(Bdata[2]);
-				putchar(Bdata[3]);
-				putchar(Bdata[4]);
-				putchar(Bdata[5]);
-				putchar(Bdata[6]);
-				putchar(Bdata[7]);
-				putchar(Bdata[8]);
 				putchar('*');
 				
 			}
@@ -419,24 +1287,88 @@ for(j=0;j<16;j++)
 		}
 			
 			}
-			//		if(DEBUGGING_ON)
-		//{
-			
-
-		//}
-		//		rf_send(DEST_ADDR, txBuffer, 99);
-			//delay_ms(7);
+					if(DEBUGGING_ON && DEBUGGING_BINARY)
+		{
+			uartFrame_send(UARTFRAME_TYPE_BEND,bendSeq,bendTime,sweepSamples,SWEEP_SAMPLES);
+		}
+#if GLOVE_CLASSIFY
+		bendSendRaw = isKeyframe(&bendSinceKeyframe);
+#endif
+		queueFrame(GLOVEFRAME_TYPE_BEND,bendTime);
+		queueSettle();
+		bendSeq++;
 			
 			}
 }
 
+#ifdef RF_USE_TX_QUEUE
+/*------------------------------------------------------------------------------
+ * A queued frame has gone out. Its buffer is reused in turn by queueBuffer(),
+ * and a frame the radio could not send is not retried.
+ */
+void rf_txDone(const uint8_t* msg, status_t status)
+{
+	UNUSED(msg);
+	UNUSED(status);
+#if GLOVE_TDMA
+	radioFrames--;
+#endif
+}
+
+#endif
 /*------------------------------------------------------------------------------
- * Ignore any received packets.
+ * Keep any rate frame received for applyRate(), beacon for applyBeacon() or
+ * base station time for applySync(), and ignore other packets.
  */
 void rf_callback(volatile rf_msgType* msg)
 {
+#if GLOVE_TDMA || GLOVE_TIME_SYNC
+	/* Captured by the radio at the SFD, as the base station's send time is */
+	uint16_t arrived = msg->sfdTime;
+#endif
+#if GLOVE_TIME_SYNC
+	gloveFrame_headerType header;
+#endif
+#if GLOVE_TDMA
+	uint16_t length;
+	uint8_t count;
+	uint8_t slot;
+#endif
+#if GLOVE_REMOTE_RATES
+	uint8_t type;
+	uint16_t rate;
+#endif
 
+#if GLOVE_TIME_SYNC
+	if(gloveFrame_readHeader((const uint8_t*)msg->data,msg->length,&header) == STATUS_OK &&
+	   (header.type == GLOVEFRAME_TYPE_SYNC || header.type == GLOVEFRAME_TYPE_BEACON))
+	{
+		syncArrived = arrived;
+		syncTime = header.time;
+		syncSeq = header.seq;
+		isSyncNew = true;
+	}
+#endif
+#if GLOVE_TDMA
+	if(gloveFrame_readBeacon((const uint8_t*)msg->data,msg->length,RF_LOCAL_ADDRESS,&length,&count,&slot) == STATUS_OK)
+	{
+		beaconTime = arrived;
+		beaconSlotLength = length;
+		beaconSlotCount = count;
+		beaconSlot = slot;
+		isBeaconNew = true;
+	}
+#endif
+#if GLOVE_REMOTE_RATES
+	if(gloveFrame_readRate((const uint8_t*)msg->data,msg->length,&type,&rate) == STATUS_OK)
+	{
+		rateValue = rate;
+		rateType = type;
+	}
+#endif
+#if !GLOVE_RECEIVE
 	UNUSED(msg);
+#endif
  
 				//adc_init(1, 10, ADC_REF_INTERNAL);
 
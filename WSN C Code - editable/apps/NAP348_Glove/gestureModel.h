@@ -0,0 +1,40 @@
+/* Gesture centroids for gesture.h, generated by Host/gestureExport from
+ * GestureData/GestureTypes.dat. Do not edit. */
+
+#ifndef GESTUREMODEL_H
+#define GESTUREMODEL_H
+
+#define GESTURE_MODEL_COUNT   4
+#define GESTURE_MODEL_VALUES  48
+#define GESTURE_MODEL_SHIFT   5
+
+/* Gesture numbers */
+/*   1 Flat */
+/*   2 Peace */
+/*   3 ThumbsUp */
+/*   4 OK */
+
+static const int8_t gestureCentroids[GESTURE_MODEL_COUNT * GESTURE_MODEL_VALUES] GESTURE_FLASH = {
+    /* Flat */
+       0,   0,   0,   7,   2,   4,   0,   0,   0,  -2,  -2,   7,
+      -2,  -1,   8,  -2,  -2,   6,  -3,  -1,   8,  -2,  -1,   7,
+      -2,  -1,   7,  -2,  -1,   6,  -2,   1,   7,  -1,  -1,   7,
+      -2,   0,   7,  -3,   0,   8,   8,   1,   0,   2,   2,   7,
+    /* Peace */
+       0,   0,   0,   2,   4,   7,   0,   0,   0,   0,   7,   2,
+      -1,   7,   5,  -4,   6,   0,  -4,   7,   2,  -2,   3,   6,
+      -4,  -7,   1,  -4,  -7,   1,  -4,   1,   6,  -3,  -6,   4,
+      -4,  -5,   4,  -5,   2,   6,   3,   7,   3,   3,  -7,   2,
+    /* ThumbsUp */
+       0,   0,   0,   0,   0,   0,   0,   0,   0,  -7,  -1,  -2,
+      -8,   0,   2,  -8,   0,  -2,  -8,   1,   0,  -7,   0,   1,
+      -8,   0,   0,  -8,   0,  -2,  -8,   0,   0,  -7,   0,   3,
+      -8,   1,   0,  -8,   1,   0,  -1,   4,   7,   8,  -2,   1,
+    /* OK */
+       0,   0,   0,   0,   0,   0,   0,   0,   0,   2,  -4,   6,
+       2,   4,   7,   0,   1,   7,  -1,   4,   7,   1,   6,   5,
+       0,   5,   6,  -2,   5,   5,  -1,   7,   3,   0,   6,   4,
+       0,   7,   4,  -1,   6,   5,   6,   5,  -1,   0,  -7,   3,
+};
+
+#endif
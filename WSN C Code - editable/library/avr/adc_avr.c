@@ -55,10 +55,53 @@
 #endif
 
 
+/* A pipelined scan moves the mux from a Timer2 overflow once the last result
+ * conversion of a step has sampled its input. Only on the ATmega128, where
+ * Timer2 is otherwise only used by delay_ms(); on the ATmega1281 it keeps the
+ * real-time clock, so the scan is not pipelined there. */
+#ifndef _AVR_IOMXX0_1_H_
+#   define ADC_PIPELINE_TIMER
+
+/* ADC clock divider chosen by adc_init(). */
+#   define ADC_DIVISION     (F_CPU / 200000UL)
+#   define ADC_DIVIDER      (ADC_DIVISION < 2  ? 2  : ADC_DIVISION < 4  ? 4  : \
+                             ADC_DIVISION < 8  ? 8  : ADC_DIVISION < 16 ? 16 : \
+                             ADC_DIVISION < 32 ? 32 : ADC_DIVISION < 64 ? 64 : \
+                             128)
+
+/* Timer2 counts F_CPU / 8 while timing the sample-and-hold, which ends at most
+ * 2.5 ADC clocks after ADSC is set (20us with an 8MHz clock). */
+#   define PRESCALE_T2_DIV8 BIT(CS21)
+#   define SAMPLE_HOLD_T2_TICKS ((ADC_DIVIDER * 5 / 2 + 7) / 8)
+#endif
+
+
 /* The result of the most recent conversion from adc_startContinuous(). */
 static volatile uint16_t result_local = 0;
 static volatile bool isNewValue = false;
 
+/* State of the scan started by adc_startScan(). */
+static volatile bool isScanning = false;
+static const adc_scanType* activeScan;
+static adc_ringType* scanRing;
+static uint8_t scanStep;
+static uint8_t scanChannel;
+static uint8_t scanIndex;
+static uint8_t scanDiscard;
+static volatile uint8_t muxStep;    /* Step the stepHook last moved to */
+
+/* While calibrating, every result uses calibrateSettle instead of the table. */
+static bool isCalibrating = false;
+static uint8_t calibrateSettle;
+
+
+static uint8_t getSettle(uint8_t index);
+static void scanNext(uint16_t result);
+static void startScanConversion(void);
+static void stopStepTimer(void);
+static void runScan(const adc_scanType* scan, adc_ringType* ring,
+        uint16_t* results);
+
 
 /******************************************************************************\
  * See adc.h for documentation of these functions.
@@ -184,6 +227,98 @@ uint16_t adc_singleConversion(void)
 }
 
 
+void adc_startScan(const adc_scanType* scan, adc_ringType* ring)
+{
+    /* Check that ADC is enabled */
+    if ( !(ADCSRA & BIT(ADEN)) || scan->channelCount == 0 || scan->steps == 0) {
+        return;
+    }
+
+    disableInterrupts();
+    activeScan = scan;
+    scanRing = ring;
+    scanStep = 0;
+    scanChannel = 0;
+    scanIndex = 0;
+    scanDiscard = getSettle(0);
+    isScanning = true;
+
+    stopStepTimer();
+    if (scan->stepHook != NULL) {
+        scan->stepHook(0);
+    }
+    muxStep = 0;
+    ADMUX = (ADMUX & ~ADC_MAX_CHANNEL) | scan->channels[0];
+    ADCSRA &= ~BIT(ADFR);
+    startScanConversion();
+    enableInterrupts();
+}
+
+
+bool adc_isScanning(void)
+{
+    return isScanning;
+}
+
+
+void adc_stopScan(void)
+{
+    isScanning = false;
+    stopStepTimer();
+}
+
+
+void adc_calibrateScan(adc_scanType* scan, adc_ringType* ring,
+        uint16_t* reference, uint8_t maxSettle, uint16_t tolerance)
+{
+    uint8_t total = scan->steps * scan->channelCount;
+    uint8_t settle, i;
+    uint16_t value;
+
+    isCalibrating = true;
+
+    /* Readings with the longest settling time are used as the reference */
+    calibrateSettle = maxSettle;
+    runScan(scan, ring, reference);
+    for (i = 0; i < total; ++i) {
+        scan->settle[i] = maxSettle;
+    }
+
+    for (settle = 0; settle < maxSettle; ++settle) {
+        calibrateSettle = settle;
+        runScan(scan, ring, NULL);
+        for (i = 0; i < total; ++i) {
+            if ( !adc_ringRead(ring, &value)) {
+                break;
+            }
+            if (scan->settle[i] > settle &&
+                    value + tolerance >= reference[i] &&
+                    value <= reference[i] + tolerance) {
+                scan->settle[i] = settle;
+            }
+        }
+    }
+
+    isCalibrating = false;
+}
+
+
+bool adc_ringRead(adc_ringType* ring, uint16_t* value)
+{
+    uint8_t tail = ring->tail;
+
+    if (tail == ring->head) {
+        return false;
+    }
+    *value = ring->data[tail];
+    if (++tail == ring->size) {
+        tail = 0;
+    }
+    ring->tail = tail;
+    return true;
+}
+
+
 void adc_disable(void)
 {
     ADCSRA &= ~(BIT(ADEN) | BIT(ADIE));
@@ -200,10 +335,131 @@ void adc_enable(void)
  * Functions used only within this file.
 \******************************************************************************/
 
+/*------------------------------------------------------------------------------
+ * Number of settling conversions to do before a result of the active scan.
+ */
+static uint8_t getSettle(uint8_t index)
+{
+    if (isCalibrating) {
+        return calibrateSettle;
+    }
+    if (activeScan->settle == NULL) {
+        return 0;
+    }
+    return activeScan->settle[index];
+}
+
+
+/*------------------------------------------------------------------------------
+ * Called from the ADC interrupt during a scan. Stores the result (unless it
+ * was a settling conversion), moves on to the next channel or step, and starts
+ * the next conversion.
+ */
+static void scanNext(uint16_t result)
+{
+    const adc_scanType* scan = activeScan;
+    adc_ringType* ring = scanRing;
+    uint8_t head;
+
+    if (scanDiscard != 0) {
+        scanDiscard--;
+    } else {
+        /* Write result, or count it as lost if the buffer is full */
+        head = ring->head + 1;
+        if (head == ring->size) {
+            head = 0;
+        }
+        if (head == ring->tail) {
+            ring->overflows++;
+        } else {
+            ring->data[ring->head] = result;
+            ring->head = head;
+        }
+
+        scanIndex++;
+        if (++scanChannel == scan->channelCount) {
+            scanChannel = 0;
+            if (++scanStep == scan->steps) {
+                isScanning = false;
+                return;
+            }
+            /* A pipelined scan has normally moved to this step already */
+            stopStepTimer();
+            if (scan->stepHook != NULL && muxStep != scanStep) {
+                scan->stepHook(scanStep);
+                muxStep = scanStep;
+            }
+        }
+        ADMUX = (ADMUX & ~ADC_MAX_CHANNEL) | scan->channels[scanChannel];
+        scanDiscard = getSettle(scanIndex);
+    }
+    startScanConversion();
+}
+
+
+/*------------------------------------------------------------------------------
+ * Starts the next conversion of a scan. If it is the last result of a step in
+ * a pipelined scan, Timer2 is started to move to the next step as soon as the
+ * input has been sampled, so the mux settles while the conversion finishes.
+ */
+static void startScanConversion(void)
+{
+    ADCSRA |= BIT(ADSC);
+
+#ifdef ADC_PIPELINE_TIMER
+    const adc_scanType* scan = activeScan;
+
+    if (scan->isPipelined && scan->stepHook != NULL && scanDiscard == 0 &&
+            scanChannel == scan->channelCount - 1 &&
+            scanStep + 1 < scan->steps) {
+        TCCR2 = 0;
+        TCNT2 = 256 - SAMPLE_HOLD_T2_TICKS;
+        TIFR = BIT(TOV2);
+        TIMSK |= BIT(TOIE2);
+        TCCR2 = PRESCALE_T2_DIV8;
+    }
+#endif
+}
+
+
+/*------------------------------------------------------------------------------
+ * Stops the Timer2 overflow started by startScanConversion(), if it has not
+ * happened yet.
+ */
+static void stopStepTimer(void)
+{
+#ifdef ADC_PIPELINE_TIMER
+    TIMSK &= ~BIT(TOIE2);
+    TCCR2 = 0;
+#endif
+}
+
+
+/*------------------------------------------------------------------------------
+ * Do a complete scan and wait for it to finish. If results is not NULL, the
+ * results are moved there from the ring buffer.
+ */
+static void runScan(const adc_scanType* scan, adc_ringType* ring,
+        uint16_t* results)
+{
+    ring->tail = ring->head;
+    adc_startScan(scan, ring);
+    while (isScanning) {
+        ;
+    }
+    if (results != NULL) {
+        while (adc_ringRead(ring, results)) {
+            results++;
+        }
+    }
+}
+
+
 /**
  * Interrupt service routine that is signalled when an ADC conversion has
  * finished. The resulting value is stored locally, and a flag set to indicate
- * that a new value has been generated.
+ * that a new value has been generated. During a scan the value is passed to
+ * scanNext() instead.
  **/
 ISR(ADC_vect)
 {
@@ -212,9 +468,30 @@ ISR(ADC_vect)
     /* Must read ADCL before ADCH */
     resultLowByte = ADCL;
     result_local = TO_UINT16(ADCH, resultLowByte);
+    if (isScanning) {
+        scanNext(result_local);
+        return;
+    }
     isNewValue = true;
     
 #ifdef ADC_USE_CALLBACK
     adc_callback(result_local);
 #endif
 }
+
+
+#ifdef ADC_PIPELINE_TIMER
+/**
+ * Interrupt service routine that is signalled once the last conversion of a
+ * step in a pipelined scan has sampled its input. Moves the scan to the next
+ * step, so the external mux settles while that conversion finishes.
+ **/
+ISR(TIMER2_OVF_vect)
+{
+    stopStepTimer();
+    if (isScanning && muxStep == scanStep) {
+        muxStep = scanStep + 1;
+        activeScan->stepHook(muxStep);
+    }
+}
+#endif
@@ -149,4 +149,112 @@
 #define ADC_MAX_CHANNEL         0x1F
 
 
+/**
+ * Ring buffer that scan results are written into. The application provides
+ * the storage, and reads results with @c adc_ringRead(). The buffer can hold
+ * @c size - 1 results.
+ **/
+typedef struct {
+    uint16_t* data;             /**< Storage for results. **/
+    uint8_t size;               /**< Number of entries in @c data. **/
+    volatile uint8_t head;      /**< Next entry written by the interrupt. **/
+    volatile uint8_t tail;      /**< Next entry read by the application. **/
+    volatile uint8_t overflows; /**< Results lost because the buffer was full. **/
+} adc_ringType;
+
+
+/**
+ * Function called by a scan when it moves to the next step, e.g. to change the
+ * address of an external analogue multiplexer. It is called from the ADC
+ * interrupt, so it should be short.
+ *
+ * @param step number of the step that is starting (0 for the first).
+ **/
+typedef void (*adc_stepHook)(uint8_t step);
+
+
+/**
+ * Description of a scan. At each step, @c stepHook is called and then each
+ * channel in @c channels is converted once. Before each result, the number of
+ * conversions given by the matching entry of @c settle are done and thrown
+ * away, to let the input settle. Each settling conversion takes 13 ADC clock
+ * cycles (104us with an 8MHz clock).
+ *
+ * If @c isPipelined is set, the hook for the next step is called from a
+ * Timer2 overflow once the last conversion of a step has sampled its input
+ * (2.5 ADC clock cycles after it is started), so the external mux settles
+ * while that conversion finishes. delay_ms() uses Timer2 too, so it must not
+ * be called during a pipelined scan. On the ATmega1281, and otherwise, the
+ * hook is called just before the first conversion of the step is started.
+ **/
+typedef struct {
+    const uint8_t* channels;    /**< Channels to convert at each step. **/
+    uint8_t channelCount;       /**< Number of entries in @c channels. **/
+    uint8_t steps;              /**< Number of steps. **/
+    adc_stepHook stepHook;      /**< Called at each step, or @c NULL. **/
+    uint8_t* settle;            /**< Settling conversions before each result
+                                     (@c steps * @c channelCount entries, in
+                                     order of step then channel), or @c NULL
+                                     for none. **/
+    bool isPipelined;           /**< Move to the next step early. **/
+} adc_scanType;
+
+
+/**
+ * Start a scan of ADC channels, which runs from the ADC interrupt. The results
+ * are written to @a ring in order of step, then channel, and the scan stops
+ * after the last step. @c adc_init() should be called first to set the
+ * reference voltage.
+ *
+ * While a scan is running, the other ADC functions should not be used, and
+ * @c adc_callback() is not called.
+ *
+ * @param scan what to convert. This must not be changed while the scan runs.
+ * @param ring where to write the results.
+ **/
+void adc_startScan(const adc_scanType* scan, adc_ringType* ring);
+
+
+/**
+ * Check if a scan is still running.
+ *
+ * @return @c true if the scan started by @c adc_startScan() has not finished.
+ **/
+bool adc_isScanning(void);
+
+
+/**
+ * Find the smallest settling time for each result of a scan. A reference scan
+ * is done with @a maxSettle settling conversions for every result. Scans are
+ * then repeated with 0, 1, 2... settling conversions, and each entry of
+ * @c scan->settle is set to the first value that gave a result within
+ * @a tolerance of the reference. Entries that never got within tolerance are
+ * left at @a maxSettle. The inputs should be kept steady while this runs.
+ *
+ * @param scan scan to calibrate. Its @c settle table is written.
+ * @param ring ring buffer with space for a full scan. It is emptied first.
+ * @param[out] reference space for @c steps * @c channelCount readings, which
+ *     are the reference readings when the function returns.
+ * @param maxSettle longest settling time to try.
+ * @param tolerance largest allowed difference from the reference reading.
+ **/
+void adc_calibrateScan(adc_scanType* scan, adc_ringType* ring,
+        uint16_t* reference, uint8_t maxSettle, uint16_t tolerance);
+
+
+/** Stop a scan after the conversion that is in progress. **/
+void adc_stopScan(void);
+
+
+/**
+ * Read the oldest result from a ring buffer.
+ *
+ * @param ring ring buffer to read from.
+ * @param[out] value where to store the result.
+ *
+ * @return @c true if a result was read, or @c false if the buffer was empty.
+ **/
+bool adc_ringRead(adc_ringType* ring, uint16_t* value);
+
+
 #endif
@@ -28,7 +28,7 @@
 
 /***************************************************************************//**
  * Code for using Texas Instruments CC2420 / Ember EM2420.
- * @todo make use of encryption and auto-ack features of chip.
+ * @todo make use of encryption features of chip.
  *
  * @file rf_2420.c
  * @date 15-Jan-2010
@@ -124,8 +124,51 @@
 /* FCF, seq. num., PAN ID, dest. address, srcs address, footer */
 #define RF_PACKET_OVERHEAD_SIZE     (2 + 1 + 2 + 2 + 2 + 2)
 
-/* FCF (Frame control field) */
-#define RF_FCF_NOACK                0x8861
+/* FCF, seq. num., PAN ID, dest. address, srcs address */
+#define RF_HEADER_SIZE              (2 + 1 + 2 + 2 + 2)
+
+/* Offsets of fields in the header */
+#define RF_HEADER_FCF               0
+#define RF_HEADER_SEQ               2
+#define RF_HEADER_PANID             3
+#define RF_HEADER_DEST              5
+#define RF_HEADER_SRC               7
+
+/* RSSI and CRC/correlation */
+#define RF_FOOTER_SIZE              2
+
+/* FCF (Frame control field): data frame, intra-PAN, short addresses */
+#define RF_FCF_NOACK                0x8841
+#define RF_FCF_ACK_REQUEST          0x0020
+#define RF_FCF_ACK                  (RF_FCF_NOACK | RF_FCF_ACK_REQUEST)
+
+/* Frame type bits of the FCF, and their value for an acknowledgement */
+#define RF_FCF_TYPE_MASK            0x07
+#define RF_FCF_TYPE_ACK             0x02
+
+/* Length byte of an acknowledgement: FCF, seq. num., footer */
+#define RF_ACK_LENGTH               (2 + 1 + 2)
+
+/* MDMCTRL0 reset value, and with AUTOACK set */
+#define RF_MDMCTRL0_DEFAULT         0x0AE2
+#define RF_MDMCTRL0_AUTOACK         (RF_MDMCTRL0_DEFAULT | BIT(4))
+
+/* Step when polling for an acknowledgement */
+#define RF_ACK_POLL_US              10
+
+/* CSMA/CA backoff period: 20 symbols of 16us */
+#define RF_CSMA_UNIT_US             320
+
+/* Time for RSSI to become valid after the receiver is turned on: 8 symbols */
+#define RF_RSSI_SETTLE_US           128
+
+/* Timer3 counts at F_CPU / 8 while a backoff is timed */
+#define PRESCALE_T3_DIV_8           BIT(CS31)
+#define US_TO_T3_TICKS(us)          ((uint16_t)((us) * (F_CPU / 8 / 1000000UL)))
+
+#if defined(RF_CARRIER_DETECT) && defined(BOARD_HAS_NO_TOSC1_CRYSTAL)
+#error "RF_CARRIER_DETECT uses Timer3, which delay_s() needs on this board"
+#endif
 
 #define RF_LENGTH_MASK              0x7F
 #define RF_CRC_OK_MASK              0x80
@@ -173,8 +216,8 @@ static uint8_t getByte(void);
 static void sendByte(uint8_t byte);
 static void setRegister(uint8_t address, uint16_t value);
 static void sendRamAddress(uint16_t address);
-static void writeFifo(const uint8_t* data, uint8_t size);
-static void getFifo(volatile uint8_t* data, uint8_t size);
+static void loadTxFifo(uint16_t fcf, uint8_t seq, uint16_t address,
+        const uint8_t* msg, uint8_t length);
 static void discardFifo(uint8_t size);
 
 
@@ -191,12 +234,102 @@ static uint16_t panId = RF_NETWORK_ID;
 /** Where to put bytes received over the radio. **/
 static volatile rf_msgType* buffer;
 
+/** If not NULL, received messages are put here instead of in buffer. **/
+static rf_queueType* rxQueue;
+
+/** SFD capture of the last message sent, and whether that message was sent. **/
+static volatile uint16_t txSfdTime;
+static volatile bool isTxSfdValid = false;
+
+#ifdef RF_USE_TX_QUEUE
+/** SFD capture of a message being received, saved when the capture is moved
+ * to the falling edge to wait for it to end. **/
+static volatile uint16_t rxSfdTime;
+static volatile bool isRxSfdSaved = false;
+#endif
+
+#ifdef RF_USE_ACK
+/** Statistics for a node, and the last acknowledged message from it. **/
+typedef struct {
+    rf_linkStatsType stats;
+    uint8_t rxSeqNumber;
+    bool isRxSeqValid;
+} linkType;
+
+/** Nodes that messages have been sent to or acknowledged from. **/
+static linkType links[RF_LINK_TABLE_SIZE];
+static uint8_t linkCount;
+
+/** Sequence number of the message waiting for an acknowledgement. **/
+static volatile uint8_t ackSeqNumber;
+
+/** Set by the receive interrupt when the acknowledgement arrives. **/
+static volatile bool isAcked;
+
+static linkType* findLink(uint16_t address);
+static bool sendWithAck(uint16_t address, const uint8_t* msg, uint8_t length,
+        uint8_t seq);
+#endif
+
+#ifdef RF_CARRIER_DETECT
+/* Values of csmaResult. */
+#define CSMA_PENDING    0   /* Backing off */
+#define CSMA_SENT       1   /* The channel was clear and the TX started */
+#define CSMA_FAILED     2   /* The channel was busy RF_CSMA_MAX_BACKOFFS + 1 times */
+
+/** Outcome of the CSMA/CA run for the packet in the TX FIFO. **/
+static volatile uint8_t csmaResult;
+
+/** Busy channel assessments so far (NB), and backoff exponent (BE). **/
+static uint8_t csmaBackoffs;
+static uint8_t csmaExponent;
+
+/** State of the random number generator for backoffs. **/
+static uint16_t csmaRandom;
+
+static rf_csmaStatsType csmaStats;
+
+static void startCsma(void);
+static bool sendCsma(void);
+static void startBackoff(void);
+#endif
+
 /** Mode that radio is currently in. **/
 static uint8_t rf_mode = RF_MODE_SLEEP;
 
 /** Current RF output power. **/
 static uint8_t rf_power;
 
+#ifdef RF_USE_TX_QUEUE
+/** A message waiting to be sent by rf_sendAsync(). **/
+typedef struct {
+    uint16_t address;
+    const uint8_t* msg;
+    uint8_t length;
+} txDescriptorType;
+
+/** Queued messages. The oldest, at txHead, is the one being sent. **/
+static txDescriptorType txQueue[RF_TX_QUEUE_SIZE];
+static volatile uint8_t txHead;
+static volatile uint8_t txCount;
+
+/* Values of txState. */
+#define TX_IDLE         0   /* Queue empty */
+#define TX_RX_WAIT      1   /* Waiting for SFD to fall at the end of an RX */
+#define TX_STARTING     2   /* TX strobed, waiting for SFD to rise */
+#define TX_SENDING      3   /* Waiting for SFD to fall at the end of the TX */
+#define TX_CSMA         4   /* Waiting for CSMA/CA to strobe TX */
+
+/** What the SFD interrupt is waiting for. **/
+static volatile uint8_t txState = TX_IDLE;
+
+/** Go back to sleep mode when the queue is empty. **/
+static bool txSleepAfter;
+
+static void startQueued(void);
+static void finishQueued(status_t status);
+#endif
+
 
 /******************************************************************************\
  * See rf.h for documentation of these functions.
@@ -226,6 +359,9 @@ void rf_init(uint16_t channel, uint8_t power)
     /* Initialize the FIFOP external interrupt */
     rf_initInterrupt();
 
+    /* Timestamp the start of each packet */
+    rf_captureSfdStart();
+
     /* Disable interrupts while accessing SPI */
     disableInterrupts();
 
@@ -235,6 +371,11 @@ void rf_init(uint16_t channel, uint8_t power)
     /* Set correlation threshold to 20 */
     setRegister(MDMCTRL1, 0x0500);
 
+#ifdef RF_USE_ACK
+    /* Acknowledge received messages that ask for it */
+    setRegister(MDMCTRL0, RF_MDMCTRL0_AUTOACK);
+#endif
+
     /* Set RXBPF to 1 as recommended in datasheet */
     setRegister(RXCTRL1, 0x2A56);
 
@@ -246,6 +387,11 @@ void rf_init(uint16_t channel, uint8_t power)
 
     txSeqNumber = 0;
 
+#ifdef RF_CARRIER_DETECT
+    /* Nodes with different addresses back off differently */
+    csmaRandom = RF_LOCAL_ADDRESS | 1;
+#endif
+
     /* Wait for the crystal oscillator to become stable */
     do {
         statusByte = getByte();
@@ -273,8 +419,14 @@ void rf_init(uint16_t channel, uint8_t power)
 
 void rf_send(uint16_t address, const uint8_t* msg, uint8_t length)
 {
-    uint16_t frameControlField = RF_FCF_NOACK;
-    uint8_t packetLength = length + RF_PACKET_OVERHEAD_SIZE;
+#ifdef RF_USE_TX_QUEUE
+    while (rf_sendAsync(address, msg, length) == STATUS_COMM_ERROR) {
+        ;
+    }
+    while (txCount != 0) {
+        ;
+    }
+#else
     uint8_t oldMode;
 
     if (length > RF_MAX_PAYLOAD_SIZE) {
@@ -295,30 +447,24 @@ void rf_send(uint16_t address, const uint8_t* msg, uint8_t length)
 
     /* Flush the TX FIFO buffer */
     sendByte(SFLUSHTX);
+    isTxSfdValid = false;
 
 #ifdef RF_CARRIER_DETECT
-    uint8_t statusByte;
-    /* Turn on receiver and wait for RSSI values to be valid */
+    /* Turn on receiver for clear channel assessment */
     if (rf_mode != RF_MODE_RECEIVING) {
         sendByte(SRXON);
     }
-    do {
-        statusByte = getByte();
-    } while (!(statusByte & BIT(RSSI_VALID)));
 #endif
 
-    /* Write packet to the TX FIFO (footer is appended automatically) */
-    writeFifo(&packetLength, 1);                    /* Packet Length */
-    writeFifo((uint8_t*)&frameControlField, 2);     /* Frame control field */
-    writeFifo(&txSeqNumber, 1);                     /* Sequence Number */
-    writeFifo((uint8_t*)&panId, 2);                 /* PAN ID */
-    writeFifo((uint8_t*)&address, 2);               /* Destination address */
-    writeFifo((uint8_t*)&shortAddress, 2);          /* Source address */
-    writeFifo(msg, length);                         /* Payload */
+    loadTxFifo(RF_FCF_NOACK, txSeqNumber, address, msg, length);
 
     /* Send packet */
 #ifdef RF_CARRIER_DETECT
-    sendByte(STXONCCA);
+    if (!sendCsma()) {
+        enableInterrupts();
+        rf_setMode(oldMode);
+        return;
+    }
 #else
     sendByte(STXON);
 #endif
@@ -327,6 +473,8 @@ void rf_send(uint16_t address, const uint8_t* msg, uint8_t length)
     while (!isSfd()) {
         ;
     }
+    txSfdTime = RF_SFD_CAPTURE;
+    isTxSfdValid = true;
 
     /* Increment the sequence number*/
     txSeqNumber++;
@@ -346,6 +494,176 @@ void rf_send(uint16_t address, const uint8_t* msg, uint8_t length)
 
     /* Turn interrupts back on */
     enableInterrupts();
+#endif
+}
+
+
+#ifdef RF_USE_TX_QUEUE
+status_t rf_sendAsync(uint16_t address, const uint8_t* msg, uint8_t length)
+{
+    txDescriptorType* tx;
+    uint8_t sreg;
+
+    if (length > RF_MAX_PAYLOAD_SIZE || rf_mode == RF_MODE_OFF) {
+        return STATUS_INVALID_ARG;
+    }
+    if (txCount == RF_TX_QUEUE_SIZE) {
+        return STATUS_COMM_ERROR;
+    }
+
+    sreg = SREG;
+    disableInterrupts();
+
+    /* The oscillator must be on to send. It is checked with interrupts
+     * disabled, as the SFD interrupt turns it off when it empties the queue
+     * after an earlier wake-up. rf_setMode() can't be used, since it enables
+     * interrupts. */
+    if (rf_mode == RF_MODE_SLEEP) {
+        sendByte(SXOSCON);
+        while (!(getByte() & BIT(XOSC16M_STABLE))) {
+            ;
+        }
+        rf_mode = RF_MODE_STANDBY;
+        txSleepAfter = true;
+    }
+
+    tx = &txQueue[(txHead + txCount) % RF_TX_QUEUE_SIZE];
+    tx->address = address;
+    tx->msg = msg;
+    tx->length = length;
+    txCount++;
+    if (txState == TX_IDLE) {
+        startQueued();
+    }
+    SREG = sreg;
+
+    return STATUS_OK;
+}
+#endif
+
+
+#ifdef RF_USE_ACK
+status_t rf_sendAcked(uint16_t address, const uint8_t* msg, uint8_t length)
+{
+    linkType* link;
+    uint8_t oldMode;
+    uint8_t seq;
+    uint8_t attempt;
+    status_t status = STATUS_NO_ACK;
+
+    if (length > RF_MAX_PAYLOAD_SIZE || address == RF_BROADCAST_ADDRESS ||
+            rf_mode == RF_MODE_OFF) {
+        return STATUS_INVALID_ARG;
+    }
+
+#ifdef RF_USE_TX_QUEUE
+    /* Let the SFD interrupt finish sending the queue */
+    while (txCount != 0) {
+        ;
+    }
+#endif
+
+    /* The oscillator must be on */
+    oldMode = rf_mode;
+    if (rf_mode == RF_MODE_SLEEP) {
+        rf_setMode(RF_MODE_STANDBY);
+    }
+
+    disableInterrupts();
+    link = findLink(address);
+    link->stats.sent++;
+    seq = txSeqNumber++;
+    enableInterrupts();
+
+    /* Retries keep the sequence number, so the receiver can drop copies */
+    for (attempt = 0; attempt <= RF_ACK_RETRIES; attempt++) {
+        if (attempt != 0) {
+            link->stats.retried++;
+        }
+        if (sendWithAck(address, msg, length, seq)) {
+            status = STATUS_ACK;
+            break;
+        }
+    }
+
+    if (status == STATUS_ACK) {
+        link->stats.acked++;
+    } else {
+        link->stats.dropped++;
+    }
+
+    rf_setMode(oldMode);
+
+    return status;
+}
+
+
+status_t rf_getLinkStats(uint16_t address, rf_linkStatsType* stats)
+{
+    uint8_t i;
+    uint8_t sreg;
+    status_t status = STATUS_INVALID_ARG;
+
+    sreg = SREG;
+    disableInterrupts();
+    for (i = 0; i < linkCount; i++) {
+        if (links[i].stats.address == address) {
+            *stats = links[i].stats;
+            status = STATUS_OK;
+            break;
+        }
+    }
+    SREG = sreg;
+
+    return status;
+}
+#endif
+
+
+#ifdef RF_CARRIER_DETECT
+void rf_getCsmaStats(rf_csmaStatsType* stats)
+{
+    uint8_t sreg;
+
+    sreg = SREG;
+    disableInterrupts();
+    *stats = csmaStats;
+    SREG = sreg;
+}
+#endif
+
+
+status_t rf_getTxTime(uint16_t* time)
+{
+    uint8_t sreg = SREG;
+    status_t status = STATUS_COMM_ERROR;
+
+    disableInterrupts();
+    if (isTxSfdValid) {
+        *time = txSfdTime;
+        status = STATUS_OK;
+    }
+    SREG = sreg;
+
+    return status;
+}
+
+
+bool rf_isBusy(void)
+{
+    uint8_t statusByte;
+
+#ifdef RF_USE_TX_QUEUE
+    if (txCount != 0) {
+        return true;
+    }
+#endif
+
+    disableInterrupts();
+    statusByte = getByte();
+    enableInterrupts();
+
+    return (statusByte & BIT(TX_ACTIVE)) != 0;
 }
 
 
@@ -364,6 +682,17 @@ void rf_setReceiveBuffer(volatile rf_msgType* receiveBuffer)
 }
 
 
+void rf_setReceiveQueue(rf_queueType* queue)
+{
+    uint8_t sreg;
+
+    sreg = SREG;
+    disableInterrupts();
+    rxQueue = queue;
+    SREG = sreg;
+}
+
+
 void rf_setMode(uint8_t mode)
 {
     uint8_t statusByte;
@@ -372,6 +701,14 @@ void rf_setMode(uint8_t mode)
         return;
     }
 
+#ifdef RF_USE_TX_QUEUE
+    /* Let the SFD interrupt finish sending the queue */
+    while (txCount != 0) {
+        ;
+    }
+    txSleepAfter = false;
+#endif
+
     disableInterrupts();
 
     /* Wait until any active transmission is finished before changing */
@@ -499,9 +836,14 @@ void rf_setUnicastAddress(void)
  **/
 ISR(RF_INT_VECTOR)
 {
-    uint16_t frameControlField;
+    volatile rf_msgType* msg = buffer;
     uint8_t length;
-    uint8_t footer[2];
+    uint8_t head = 0;
+    uint8_t header[RF_HEADER_SIZE];
+    uint8_t footer[RF_FOOTER_SIZE];
+#ifdef RF_USE_ACK
+    linkType* link;
+#endif
 
     /* Check if FIFO overflow has happened */
     if((isFifop()) && (!(isFifo()))) {
@@ -509,45 +851,445 @@ ISR(RF_INT_VECTOR)
         return;
     }
 
+    /* Read the whole packet in one burst */
+    spi_enableCsn();
+    spi_readWriteByte(RXFIFO | REG_READ);
+
     /* Payload length */
-    getFifo(&length, 1);
-    length &= RF_LENGTH_MASK;
+    length = spi_readWriteByte(0) & RF_LENGTH_MASK;
+
+#ifdef RF_USE_ACK
+    /* Acknowledgement for rf_sendAcked() */
+    if (length == RF_ACK_LENGTH) {
+        spi_readArray(header, RF_ACK_LENGTH);
+        spi_disableCsn();
+        if (((header[RF_HEADER_FCF] & RF_FCF_TYPE_MASK) == RF_FCF_TYPE_ACK) &&
+                (header[RF_HEADER_SEQ] == ackSeqNumber) &&
+                (header[RF_ACK_LENGTH - 1] & RF_CRC_OK_MASK)) {
+            isAcked = true;
+        }
+        return;
+    }
+#endif
 
-    /* Ignore the packet if the length is too short */
-    if (length < RF_PACKET_OVERHEAD_SIZE) {
+    /* Ignore the packet if it is too short, or too long for the buffer, or if
+     * there is nowhere to put it */
+    if ((length < RF_PACKET_OVERHEAD_SIZE) ||
+            (length - RF_PACKET_OVERHEAD_SIZE > RF_MAX_PAYLOAD_SIZE) ||
+            (msg == NULL && rxQueue == NULL)) {
         discardFifo(length);
+        spi_disableCsn();
         return;
     }
 
-    /* Store payload length */
-    buffer->length = length - RF_PACKET_OVERHEAD_SIZE;
-
-    /* Start reading the rest of the data */
-    getFifo((uint8_t*) &frameControlField, 2);
-    getFifo(&buffer->seqNumber, 1);
+    /* Use the next free entry of the queue, or drop the packet if it's full */
+    if (rxQueue != NULL) {
+        head = rxQueue->head;
+        msg = &rxQueue->msgs[head];
+        if (++head == rxQueue->size) {
+            head = 0;
+        }
+        if (head == rxQueue->tail) {
+            rxQueue->overflows++;
+            discardFifo(length);
+            spi_disableCsn();
+            return;
+        }
+    }
 
-    /* Ignore destination address */
-    discardFifo(4);
+    /* The capture still holds the start of this packet, unless the TX queue
+     * moved it to the end to wait for the packet to finish */
+#ifdef RF_USE_TX_QUEUE
+    if (isRxSfdSaved) {
+        msg->sfdTime = rxSfdTime;
+        isRxSfdSaved = false;
+    } else {
+        msg->sfdTime = RF_SFD_CAPTURE;
+    }
+#else
+    msg->sfdTime = RF_SFD_CAPTURE;
+#endif
 
-    /* Read the source address */
-    getFifo((volatile uint8_t*) &buffer->srcAddress, 2);
+    spi_readArray(header, RF_HEADER_SIZE);
+    spi_readArray((uint8_t*)msg->data, length - RF_PACKET_OVERHEAD_SIZE);
+    spi_readArray(footer, RF_FOOTER_SIZE);
+    spi_disableCsn();
 
-    /* Read the packet payload */
-    getFifo(buffer->data, length - RF_PACKET_OVERHEAD_SIZE);
+    /* Store payload length, sequence number and source address. The
+     * destination address is checked by the radio. */
+    msg->length = length - RF_PACKET_OVERHEAD_SIZE;
+    msg->seqNumber = header[RF_HEADER_SEQ];
+    msg->srcAddress = TO_UINT16(header[RF_HEADER_SRC + 1],
+            header[RF_HEADER_SRC]);
 
-    /* Read the footer to get the RSSI value */
-    getFifo(footer, 2);
-    
     /* Subtracting 45 as recommended by datasheet */
-    buffer->rssi = footer[0] - 45;
+    msg->rssi = footer[0] - 45;
+
+#ifdef RF_USE_ACK
+    /* The radio has acknowledged the message. If it is a retry of one that
+     * was already received, the first acknowledgement was lost. */
+    if ((header[RF_HEADER_FCF] & RF_FCF_ACK_REQUEST) &&
+            (footer[1] & RF_CRC_OK_MASK)) {
+        link = findLink(msg->srcAddress);
+        if (link->isRxSeqValid && link->rxSeqNumber == msg->seqNumber) {
+            return;
+        }
+        link->rxSeqNumber = msg->seqNumber;
+        link->isRxSeqValid = true;
+    }
+#endif
 
-    /* Check CRC, and call upper layer if ok */
+    /* Check CRC, and add to the queue and call upper layer if ok */
     if (footer[1] & RF_CRC_OK_MASK) {
-        rf_callback(buffer);
+        if (rxQueue != NULL) {
+            rxQueue->head = head;
+        }
+        rf_callback(msg);
+    }
+}
+
+
+#ifdef RF_USE_TX_QUEUE
+/**
+ * This interrupt is triggered by the edge of SFD selected by txState, and
+ * moves the message at the head of the queue on.
+ **/
+ISR(RF_SFD_VECTOR)
+{
+    switch (txState) {
+    case TX_STARTING:
+        /* SFD field sent. Wait for the end of the packet. */
+        txSfdTime = RF_SFD_CAPTURE;
+        isTxSfdValid = true;
+        txSeqNumber++;
+        txState = TX_SENDING;
+        rf_captureSfdEnd();
+        rf_clearSfdInterrupt();
+        if (isSfd()) {
+            break;
+        }
+        /* Already finished, fall through */
+
+    case TX_SENDING:
+#ifdef RF_CARRIER_DETECT
+        if (rf_mode != RF_MODE_RECEIVING) {
+            sendByte(SRFOFF);
+        }
+#endif
+        finishQueued(STATUS_OK);
+        startQueued();
+        break;
+
+    case TX_RX_WAIT:
+        /* Forget the capture if the packet was not for this node */
+        if (!isFifop()) {
+            isRxSfdSaved = false;
+        }
+        startQueued();
+        break;
+
+    default:
+        break;
     }
 }
 
 
+/**
+ * Start sending the message at the head of the queue. Messages that the radio
+ * refuses, or that CSMA/CA gives up on, are dropped. Must be called with
+ * interrupts disabled.
+ **/
+static void startQueued(void)
+{
+    txDescriptorType* tx;
+
+    while (txCount != 0) {
+        /* Wait for a packet being received to end */
+        if (isSfd()) {
+            rxSfdTime = RF_SFD_CAPTURE;
+            isRxSfdSaved = true;
+            txState = TX_RX_WAIT;
+            rf_captureSfdEnd();
+            rf_clearSfdInterrupt();
+            rf_enableSfdInterrupt();
+            return;
+        }
+
+        tx = &txQueue[txHead];
+        sendByte(SFLUSHTX);
+        isTxSfdValid = false;
+
+#ifdef RF_CARRIER_DETECT
+        /* Turn on receiver for clear channel assessment */
+        if (rf_mode != RF_MODE_RECEIVING) {
+            sendByte(SRXON);
+        }
+#endif
+
+        loadTxFifo(RF_FCF_NOACK, txSeqNumber, tx->address, tx->msg,
+                tx->length);
+        rf_captureSfdStart();
+        rf_clearSfdInterrupt();
+#ifdef RF_CARRIER_DETECT
+        /* The backoff timer interrupt carries on from here */
+        txState = TX_CSMA;
+        startCsma();
+        return;
+#else
+        sendByte(STXON);
+
+        /* The strobe is ignored if the radio can't send */
+        if (getByte() & BIT(TX_ACTIVE)) {
+            txState = TX_STARTING;
+            rf_enableSfdInterrupt();
+            return;
+        }
+        finishQueued(STATUS_COMM_ERROR);
+#endif
+    }
+
+    txState = TX_IDLE;
+    rf_disableSfdInterrupt();
+    rf_captureSfdStart();
+    if (txSleepAfter) {
+        sendByte(SXOSCOFF);
+        rf_mode = RF_MODE_SLEEP;
+        txSleepAfter = false;
+    }
+}
+
+
+/**
+ * Remove the message at the head of the queue and pass it back to the
+ * application.
+ *
+ * @param status result for rf_txDone().
+ **/
+static void finishQueued(status_t status)
+{
+    const uint8_t* msg = txQueue[txHead].msg;
+
+    txHead = (txHead + 1) % RF_TX_QUEUE_SIZE;
+    txCount--;
+    rf_txDone(msg, status);
+}
+#endif
+
+
+#ifdef RF_USE_ACK
+/**
+ * Find the entry for a node in the link table, adding it if needed. When the
+ * table is full, the last entry is reused. Must be called with interrupts
+ * disabled.
+ *
+ * @param address address of the node.
+ * @return the node's entry.
+ **/
+static linkType* findLink(uint16_t address)
+{
+    linkType* link;
+    uint8_t i;
+
+    for (i = 0; i < linkCount; i++) {
+        if (links[i].stats.address == address) {
+            return &links[i];
+        }
+    }
+    if (linkCount < RF_LINK_TABLE_SIZE) {
+        linkCount++;
+    }
+    link = &links[linkCount - 1];
+    link->stats.address = address;
+    link->stats.sent = 0;
+    link->stats.acked = 0;
+    link->stats.retried = 0;
+    link->stats.dropped = 0;
+    link->isRxSeqValid = false;
+    return link;
+}
+
+
+/**
+ * Send a message asking for an acknowledgement, and wait up to
+ * RF_ACK_WAIT_US after it has gone out for the acknowledgement. The receiver
+ * is left on after the transmission to receive it.
+ *
+ * @param address address to send data to.
+ * @param msg pointer to data that will be sent.
+ * @param length number of bytes in data to send.
+ * @param seq sequence number of the message.
+ * @return @c true if the message was acknowledged.
+ **/
+static bool sendWithAck(uint16_t address, const uint8_t* msg, uint8_t length,
+        uint8_t seq)
+{
+    uint16_t wait;
+    bool isSent = true;
+
+    disableInterrupts();
+    sendByte(SFLUSHTX);
+    ackSeqNumber = seq;
+    isAcked = false;
+    if (rf_mode != RF_MODE_RECEIVING) {
+        sendByte(SRXON);
+        sendByte(SFLUSHRX);
+        rf_clearInterrupt();
+        rf_enableInterrupt();
+    }
+
+    loadTxFifo(RF_FCF_ACK, seq, address, msg, length);
+#ifdef RF_CARRIER_DETECT
+    isSent = sendCsma();
+#else
+    sendByte(STXON);
+
+    /* The strobe is ignored if the radio can't send */
+    if (!(getByte() & BIT(TX_ACTIVE))) {
+        isSent = false;
+    }
+#endif
+    enableInterrupts();
+
+    if (isSent) {
+        /* Wait until the transmission starts, then until it ends */
+        while (!isSfd()) {
+            ;
+        }
+        while (isSfd()) {
+            ;
+        }
+
+        /* The radio is back in RX, and the receive interrupt sets isAcked */
+        for (wait = 0; wait < RF_ACK_WAIT_US && !isAcked;
+                wait += RF_ACK_POLL_US) {
+            delay_us(RF_ACK_POLL_US);
+        }
+    }
+
+    if (rf_mode != RF_MODE_RECEIVING) {
+        disableInterrupts();
+        sendByte(SRFOFF);
+        rf_disableInterrupt();
+        enableInterrupts();
+    }
+
+    return isAcked;
+}
+#endif
+
+
+#ifdef RF_CARRIER_DETECT
+/**
+ * This interrupt is triggered at the end of a CSMA/CA backoff. If the channel
+ * is clear, the packet in the TX FIFO is sent. Otherwise another, longer,
+ * backoff is started, until RF_CSMA_MAX_BACKOFFS have been tried.
+ **/
+ISR(TIMER3_COMPA_vect)
+{
+    TCCR3B = 0;
+    ETIMSK &= ~BIT(OCIE3A);
+
+    /* STXONCCA only sends if the channel is clear */
+    while (!(getByte() & BIT(RSSI_VALID))) {
+        ;
+    }
+    csmaStats.attempts++;
+    sendByte(STXONCCA);
+    if (getByte() & BIT(TX_ACTIVE)) {
+        csmaResult = CSMA_SENT;
+    } else {
+        csmaStats.busy++;
+        if (csmaBackoffs++ < RF_CSMA_MAX_BACKOFFS) {
+            if (csmaExponent < RF_CSMA_MAX_BE) {
+                csmaExponent++;
+            }
+            startBackoff();
+            return;
+        }
+        csmaStats.failures++;
+        if (rf_mode != RF_MODE_RECEIVING) {
+            sendByte(SRFOFF);
+        }
+        csmaResult = CSMA_FAILED;
+    }
+
+#ifdef RF_USE_TX_QUEUE
+    /* Carry on with the queue */
+    if (txState == TX_CSMA) {
+        if (csmaResult == CSMA_SENT) {
+            /* Forget any packet heard during the backoff. The SFD of this
+             * one is at least the preamble away. */
+            txState = TX_STARTING;
+            rf_captureSfdStart();
+            rf_clearSfdInterrupt();
+            rf_enableSfdInterrupt();
+        } else {
+            finishQueued(STATUS_COMM_ERROR);
+            startQueued();
+        }
+    }
+#endif
+}
+
+
+/**
+ * Start unslotted CSMA/CA for the packet in the TX FIFO. The receiver must be
+ * on. The result is left in csmaResult by the backoff timer interrupt. Must
+ * be called with interrupts disabled.
+ **/
+static void startCsma(void)
+{
+    csmaBackoffs = 0;
+    csmaExponent = RF_CSMA_MIN_BE;
+    csmaResult = CSMA_PENDING;
+    startBackoff();
+}
+
+
+/**
+ * Start CSMA/CA for the packet in the TX FIFO, and wait with interrupts
+ * enabled for the result. Must be called with interrupts disabled, which are
+ * disabled again on return.
+ *
+ * @return @c true if the packet is being sent.
+ **/
+static bool sendCsma(void)
+{
+    startCsma();
+    enableInterrupts();
+    while (csmaResult == CSMA_PENDING) {
+        ;
+    }
+    disableInterrupts();
+    return csmaResult == CSMA_SENT;
+}
+
+
+/**
+ * Start Timer3 for a random backoff of 0 to 2^BE - 1 backoff periods, plus
+ * the time for RSSI to become valid.
+ **/
+static void startBackoff(void)
+{
+    uint16_t periods;
+
+    /* xorshift */
+    csmaRandom ^= csmaRandom << 7;
+    csmaRandom ^= csmaRandom >> 9;
+    csmaRandom ^= csmaRandom << 8;
+    periods = csmaRandom & ((1 << csmaExponent) - 1);
+
+    TCCR3A = 0;
+    TCNT3 = 0;
+    OCR3A = US_TO_T3_TICKS(RF_RSSI_SETTLE_US) +
+            periods * US_TO_T3_TICKS(RF_CSMA_UNIT_US);
+    ETIFR = BIT(OCF3A);
+    ETIMSK |= BIT(OCIE3A);
+    TCCR3B = PRESCALE_T3_DIV_8;
+}
+#endif
+
+
 /**
  * Read single SPI byte (status byte).
  *
@@ -605,50 +1347,48 @@ static void sendRamAddress(uint16_t address)
 
 
 /**
- * Write data to the TX FIFO.
+ * Write a packet to the TX FIFO in one burst: the length byte and header,
+ * then the payload. The footer is appended by the radio.
  *
- * @param data a pointer to the data that will be written.
- * @param size how many bytes of @a data to write.
+ * @param fcf frame control field.
+ * @param seq sequence number.
+ * @param address address to send data to.
+ * @param msg the payload.
+ * @param length number of bytes in @a msg.
  **/
-static void writeFifo(const uint8_t* data, uint8_t size)
+static void loadTxFifo(uint16_t fcf, uint8_t seq, uint16_t address,
+        const uint8_t* msg, uint8_t length)
 {
-    spi_enableCsn();
-    spi_readWriteByte(TXFIFO);
-    for (uint8_t i = 0; i < size; i++) {
-        spi_readWriteByte(data[i]);
-    }
-    spi_disableCsn();
-}
-
+    uint8_t header[1 + RF_HEADER_SIZE];
+
+    header[0] = length + RF_PACKET_OVERHEAD_SIZE;   /* Packet Length */
+    header[1 + RF_HEADER_FCF] = LOW_BYTE(fcf);
+    header[1 + RF_HEADER_FCF + 1] = HIGH_BYTE(fcf);
+    header[1 + RF_HEADER_SEQ] = seq;
+    header[1 + RF_HEADER_PANID] = LOW_BYTE(panId);
+    header[1 + RF_HEADER_PANID + 1] = HIGH_BYTE(panId);
+    header[1 + RF_HEADER_DEST] = LOW_BYTE(address);
+    header[1 + RF_HEADER_DEST + 1] = HIGH_BYTE(address);
+    header[1 + RF_HEADER_SRC] = LOW_BYTE(shortAddress);
+    header[1 + RF_HEADER_SRC + 1] = HIGH_BYTE(shortAddress);
 
-/**
- * Read data from the RX FIFO.
- *
- * @param data a pointer to where to save the data that is read.
- * @param size how many bytes to read.
- **/
-static void getFifo(volatile uint8_t* data, uint8_t size)
-{
     spi_enableCsn();
-    spi_readWriteByte(RXFIFO | REG_READ);
-    for (uint8_t i = 0; i < size; i++) {
-        data[i] = spi_readWriteByte(0);
-    }
+    spi_readWriteByte(TXFIFO);
+    spi_writeArray(header, sizeof(header));
+    spi_writeArray(msg, length);
     spi_disableCsn();
 }
 
 
 /**
- * Read and ignore data from the RX FIFO.
+ * Read and ignore data from the RX FIFO. The RX FIFO must already have been
+ * selected, and is left selected.
  *
  * @param size how many bytes to read and discard.
  **/
 static void discardFifo(uint8_t size)
 {
-    spi_enableCsn();
-    spi_readWriteByte(RXFIFO | REG_READ);
     for (uint8_t i = 0; ((i < size) && isFifo()); i++){
         spi_readWriteByte(0);
     }
-    spi_disableCsn();
 }
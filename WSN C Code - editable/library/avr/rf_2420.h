@@ -85,6 +85,59 @@
 #endif
 
 
+/**
+ * Microseconds a message with @a length bytes of payload is on the air: the
+ * preamble, SFD and length byte, the 9 byte MAC header, the payload and the
+ * 2 byte FCS, at 32us a byte.
+ **/
+#define RF_AIR_TIME_US(length)     (((length) + 17) * 32UL)
+
+/** Microseconds from the transmit strobe to the start of the preamble (12
+ * symbol periods). **/
+#define RF_TX_TURNAROUND_US        192
+
+
+#if !defined(RF_TX_QUEUE_SIZE) || defined(__DOXYGEN__)
+/** Number of messages @c rf_sendAsync() can queue (with RF_USE_TX_QUEUE). **/
+#define RF_TX_QUEUE_SIZE           3
+#endif
+
+
+#if !defined(RF_ACK_RETRIES) || defined(__DOXYGEN__)
+/** Retransmissions by @c rf_sendAcked() before a message is dropped. **/
+#define RF_ACK_RETRIES             3
+#endif
+
+#if !defined(RF_ACK_WAIT_US) || defined(__DOXYGEN__)
+/**
+ * Time @c rf_sendAcked() waits for an acknowledgement after a message has
+ * been sent (IEEE 802.15.4 allows 54 symbols, or 864us).
+ **/
+#define RF_ACK_WAIT_US             1000
+#endif
+
+#if !defined(RF_LINK_TABLE_SIZE) || defined(__DOXYGEN__)
+/** Number of nodes @c rf_getLinkStats() keeps counters for (with RF_USE_ACK). **/
+#define RF_LINK_TABLE_SIZE         4
+#endif
+
+
+#if !defined(RF_CSMA_MIN_BE) || defined(__DOXYGEN__)
+/** First CSMA/CA backoff exponent (with RF_CARRIER_DETECT). **/
+#define RF_CSMA_MIN_BE             3
+#endif
+
+#if !defined(RF_CSMA_MAX_BE) || defined(__DOXYGEN__)
+/** Largest CSMA/CA backoff exponent (with RF_CARRIER_DETECT). **/
+#define RF_CSMA_MAX_BE             5
+#endif
+
+#if !defined(RF_CSMA_MAX_BACKOFFS) || defined(__DOXYGEN__)
+/** Retries after a busy channel before a message is dropped. **/
+#define RF_CSMA_MAX_BACKOFFS       4
+#endif
+
+
 /* If MAX_PAYLOAD_SIZE has been defined elsewhere, check it's size. */
 #if RF_MAX_PAYLOAD_SIZE > 115
 #error "RF_MAX_PAYLOAD_SIZE must not be > 115 for xx2420"
@@ -0,0 +1,384 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Implementation of the sampling scheduler for ATmega128 and ATmega1281, using
+ * Timer1. The timer is never cleared: each compare match moves the compare
+ * value on by one period, so the slots do not drift when an interrupt is
+ * serviced late.
+ *
+ * @file sampler_avr.c
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+
+#include <avr/sleep.h>
+#include "global.h"
+#include "sampler.h"
+
+
+/* Prescalar value for Timer1 (F_CPU / 8). */
+#define PRESCALE_T1_DIV_8       (BIT(CS11))
+#define PRESCALE_T1_BITMASK     (BIT(CS12) | BIT(CS11) | BIT(CS10))
+
+/* Fewest ticks ahead of the timer that sampler_alignGroup() sets a compare
+ * value. */
+#define ALIGN_MARGIN            32
+
+
+/* ATmega1281 compatibility. On the ATmega128 compare unit C is in the
+ * extended registers. */
+#ifdef _AVR_IOMXX0_1_H_
+#   define TIMER1_IMSK  TIMSK1
+#   define TIMER1_IFR   TIFR1
+#   define TIMER1C_IMSK TIMSK1
+#   define TIMER1C_IFR  TIFR1
+#else
+#   define TIMER1_IMSK  TIMSK
+#   define TIMER1_IFR   TIFR
+#   define TIMER1C_IMSK ETIMSK
+#   define TIMER1C_IFR  ETIFR
+#endif
+
+
+/* Timer ticks between the start of two slots, for each group. */
+static volatile uint16_t period[SAMPLER_GROUPS];
+
+/* Bit set by the interrupt when a slot of a group starts, cleared by
+ * sampler_wait() or sampler_waitGroups(). */
+static volatile uint8_t startedGroups;
+
+/* Number of slots that started before the previous one was used. */
+static volatile uint16_t overruns;
+
+/* Upper 16 bits of the time value. */
+static volatile uint16_t timeHigh;
+
+
+static uint32_t readTime(void);
+static void startCompare(uint8_t group, uint16_t start);
+static void stopGroup(uint8_t group);
+static uint8_t waitForGroups(uint8_t groups);
+
+
+/******************************************************************************\
+ * See sampler.h for documentation of these functions.
+\******************************************************************************/
+
+void sampler_init(uint16_t rate)
+{
+    disableInterrupts();
+
+    /* Normal mode, the timer is never reset */
+    TCCR1A = 0;
+    TCCR1B = PRESCALE_T1_DIV_8;
+
+    startedGroups = 0;
+    overruns = 0;
+
+    /* Count overflows to give a 32-bit timer */
+    TIMER1_IMSK |= BIT(TOIE1);
+
+    enableInterrupts();
+
+    sampler_setRate(rate);
+}
+
+
+void sampler_setRate(uint16_t rate)
+{
+    sampler_setGroupRate(0, rate);
+}
+
+
+status_t sampler_setGroupRate(uint8_t group, uint16_t rate)
+{
+    if (group >= SAMPLER_GROUPS) {
+        return STATUS_INVALID_ARG;
+    }
+    if (rate == 0) {
+        stopGroup(group);
+        return STATUS_OK;
+    }
+    if (rate < SAMPLER_MIN_RATE) {
+        rate = SAMPLER_MIN_RATE;
+    }
+    if (rate > SAMPLER_MAX_RATE) {
+        rate = SAMPLER_MAX_RATE;
+    }
+
+    disableInterrupts();
+    period[group] = SAMPLER_TICKS_PER_SECOND / rate;
+
+    /* First slot is one period from now */
+    startCompare(group, TCNT1 + period[group]);
+    enableInterrupts();
+
+    return STATUS_OK;
+}
+
+
+status_t sampler_alignGroup(uint8_t group, uint32_t start, uint16_t ticks)
+{
+    uint32_t now;
+    int32_t ahead;
+
+    if (group >= SAMPLER_GROUPS || ticks == 0) {
+        return STATUS_INVALID_ARG;
+    }
+    if (ticks < SAMPLER_TICKS_PER_SECOND / SAMPLER_MAX_RATE) {
+        ticks = SAMPLER_TICKS_PER_SECOND / SAMPLER_MAX_RATE;
+    }
+
+    disableInterrupts();
+    period[group] = ticks;
+
+    /* First slot on the grid far enough ahead that the timer can't pass the
+     * compare value while it is being written */
+    now = readTime() + ALIGN_MARGIN;
+    ahead = (int32_t)(start - now) % ticks;
+    if (ahead < 0) {
+        ahead += ticks;
+    }
+    startCompare(group, (uint16_t)now + (uint16_t)ahead);
+    enableInterrupts();
+
+    return STATUS_OK;
+}
+
+
+void sampler_stop(void)
+{
+    uint8_t group;
+
+    for (group = 0; group < SAMPLER_GROUPS; group++) {
+        stopGroup(group);
+    }
+}
+
+
+void sampler_wait(void)
+{
+    waitForGroups(BIT(0));
+}
+
+
+uint8_t sampler_waitGroups(void)
+{
+    return waitForGroups(BIT(SAMPLER_GROUPS) - 1);
+}
+
+
+uint16_t sampler_getOverruns(void)
+{
+    uint16_t count;
+
+    disableInterrupts();
+    count = overruns;
+    enableInterrupts();
+
+    return count;
+}
+
+
+uint32_t sampler_getTime(void)
+{
+    uint32_t time;
+
+    disableInterrupts();
+    time = readTime();
+    enableInterrupts();
+
+    return time;
+}
+
+
+uint16_t sampler_getTimeLow(void)
+{
+    uint8_t sreg = SREG;
+    uint16_t low;
+
+    /* The 16-bit read uses the TEMP register shared with the interrupts */
+    disableInterrupts();
+    low = TCNT1;
+    SREG = sreg;
+
+    return low;
+}
+
+
+/******************************************************************************\
+ * Functions used only within this file.
+\******************************************************************************/
+
+/**
+ * Read the 32-bit time. Must be called with interrupts disabled.
+ *
+ * @return time in units of 1 / @c SAMPLER_TICKS_PER_SECOND seconds.
+ **/
+static uint32_t readTime(void)
+{
+    uint16_t high;
+    uint16_t low;
+
+    low = TCNT1;
+    high = timeHigh;
+
+    /* Overflow has happened, but the interrupt hasn't been serviced yet */
+    if ((TIMER1_IFR & BIT(TOV1)) && (low < 0x8000)) {
+        high++;
+    }
+
+    return W_TO_UINT32(high, low);
+}
+
+
+/**
+ * Set the compare value of a group and enable its interrupt. Must be called
+ * with interrupts disabled.
+ *
+ * @param group group number, less than @c SAMPLER_GROUPS.
+ * @param start timer value at which the next slot starts.
+ **/
+static void startCompare(uint8_t group, uint16_t start)
+{
+    if (group == 0) {
+        OCR1A = start;
+        TIMER1_IFR = BIT(OCF1A);
+        TIMER1_IMSK |= BIT(OCIE1A);
+    } else if (group == 1) {
+        OCR1B = start;
+        TIMER1_IFR = BIT(OCF1B);
+        TIMER1_IMSK |= BIT(OCIE1B);
+    } else {
+        OCR1C = start;
+        TIMER1C_IFR = BIT(OCF1C);
+        TIMER1C_IMSK |= BIT(OCIE1C);
+    }
+}
+
+
+/**
+ * Stop the compare interrupt of a group.
+ *
+ * @param group group number, less than @c SAMPLER_GROUPS.
+ **/
+static void stopGroup(uint8_t group)
+{
+    disableInterrupts();
+    if (group == 0) {
+        TIMER1_IMSK &= ~BIT(OCIE1A);
+    } else if (group == 1) {
+        TIMER1_IMSK &= ~BIT(OCIE1B);
+    } else {
+        TIMER1C_IMSK &= ~BIT(OCIE1C);
+    }
+    startedGroups &= ~BIT(group);
+    enableInterrupts();
+}
+
+
+/**
+ * Sleep until the slot of at least one of the given groups has started.
+ *
+ * @param groups bit mask of the groups to wait for.
+ * @return the groups in @p groups whose slot has started, which are cleared.
+ **/
+static uint8_t waitForGroups(uint8_t groups)
+{
+    uint8_t started;
+
+    /*
+     * Interrupts are disabled while checking the flags. The instruction after
+     * "sei" is always executed before an interrupt is serviced, so the slot
+     * interrupt can't be missed between the check and going to sleep.
+     */
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    disableInterrupts();
+    while (!(startedGroups & groups)) {
+        sleep_enable();
+        enableInterrupts();
+        sleep_cpu();
+        sleep_disable();
+        disableInterrupts();
+    }
+    started = startedGroups & groups;
+    startedGroups &= ~started;
+    enableInterrupts();
+
+    return started;
+}
+
+
+/**
+ * Mark the start of a slot of a group.
+ *
+ * @param group group number, less than @c SAMPLER_GROUPS.
+ **/
+static inline void startSlot(uint8_t group)
+{
+    if (startedGroups & BIT(group)) {
+        overruns++;
+    }
+    startedGroups |= BIT(group);
+}
+
+
+/******************************************************************************\
+ * Interrupt routines.
+\******************************************************************************/
+
+/** Start of a new slot of group 0. **/
+ISR(TIMER1_COMPA_vect)
+{
+    OCR1A += period[0];
+    startSlot(0);
+}
+
+
+/** Start of a new slot of group 1. **/
+ISR(TIMER1_COMPB_vect)
+{
+    OCR1B += period[1];
+    startSlot(1);
+}
+
+
+/** Start of a new slot of group 2. **/
+ISR(TIMER1_COMPC_vect)
+{
+    OCR1C += period[2];
+    startSlot(2);
+}
+
+
+/** Extends Timer1 to 32 bits. **/
+ISR(TIMER1_OVF_vect)
+{
+    timeHigh++;
+}
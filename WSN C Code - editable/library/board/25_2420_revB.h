@@ -107,6 +107,32 @@
 /** Radio interrupt address. **/
 #define RF_INT_VECTOR       INT4_vect
 
+/*------------------------------------------------------------------------------
+ * SFD from CC2420, on the Timer1 input capture pin (ICP1). Changing the edge
+ * can set the flag, so clear it afterwards.
+ */
+
+/** Capture the rising edge of SFD (start of a packet). **/
+#define rf_captureSfdStart()        (TCCR1B |= BIT(ICES1))
+
+/** Capture the falling edge of SFD (end of a packet). **/
+#define rf_captureSfdEnd()          (TCCR1B &= ~BIT(ICES1))
+
+/** Enable SFD capture interrupt. **/
+#define rf_enableSfdInterrupt()     (TIMSK |= BIT(TICIE1))
+
+/** Disable SFD capture interrupt. **/
+#define rf_disableSfdInterrupt()    (TIMSK &= ~BIT(TICIE1))
+
+/** Reset SFD capture interrupt. **/
+#define rf_clearSfdInterrupt()      (TIFR = BIT(ICF1))
+
+/** Timer1 value at the last captured SFD edge. **/
+#define RF_SFD_CAPTURE      ICR1
+
+/** SFD capture interrupt address. **/
+#define RF_SFD_VECTOR       TIMER1_CAPT_vect
+
 /** Lowest power mode from which the CC2420 can wake up the ATmega128. **/
 #define RF_SLEEP_MODE       SLEEP_IDLE
 
@@ -0,0 +1,127 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Implementation of the boxcar filter.
+ *
+ * @file boxcar.c
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+#if !defined UC_AVR && !defined UC_8051
+#   include <stdint.h>      /* This file is also used by host tools */
+#endif
+#include "global.h"
+#include "boxcar.h"
+
+
+/******************************************************************************\
+ * See boxcar.h for documentation of these functions.
+\******************************************************************************/
+
+status_t boxcar_init(boxcar_filterType* filter, int16_t* history, int32_t* sums,
+        uint8_t channels, uint8_t length, uint8_t decimation,
+        uint8_t fractionBits)
+{
+    uint8_t i;
+
+    if (channels == 0 || length == 0 || length > BOXCAR_MAX_LENGTH ||
+            decimation == 0 || fractionBits > BOXCAR_MAX_FRACTION) {
+        return STATUS_INVALID_ARG;
+    }
+
+    filter->history = history;
+    filter->sums = sums;
+    filter->channels = channels;
+    filter->length = length;
+    filter->decimation = decimation;
+    filter->fractionBits = fractionBits;
+    filter->index = 0;
+    filter->filled = 0;
+    filter->phase = 0;
+
+    filter->shift = 0xFF;
+    for (i = 0; i < 8; ++i) {
+        if (length == (1 << i)) {
+            filter->shift = i;
+        }
+    }
+
+    for (i = 0; i < channels; ++i) {
+        sums[i] = 0;
+    }
+    return STATUS_OK;
+}
+
+
+bool boxcar_add(boxcar_filterType* filter, const int16_t* input,
+        int16_t* output)
+{
+    int16_t* history = &filter->history[filter->index * filter->channels];
+    uint8_t c, shift;
+    int32_t sum;
+    bool isFull = (filter->filled == filter->length);
+
+    /* Replace the oldest input of each channel in the running sums */
+    for (c = 0; c < filter->channels; ++c) {
+        if (isFull) {
+            filter->sums[c] -= history[c];
+        }
+        history[c] = input[c];
+        filter->sums[c] += input[c];
+    }
+
+    if (++filter->index == filter->length) {
+        filter->index = 0;
+    }
+    if (!isFull) {
+        filter->filled++;
+    }
+
+    if (++filter->phase < filter->decimation) {
+        return false;
+    }
+    filter->phase = 0;
+
+    shift = (filter->filled == filter->length) ? filter->shift : 0xFF;
+    for (c = 0; c < filter->channels; ++c) {
+        sum = filter->sums[c] * (1 << filter->fractionBits);
+        /* Halves are rounded away from zero either way. The shift rounds
+         * down, so a negative half must not be carried up. */
+        if (shift != 0xFF && sum >= 0) {
+            output[c] = (int16_t)((sum + ((1L << shift) >> 1)) >> shift);
+        } else if (shift != 0xFF) {
+            output[c] = (int16_t)((sum + (((1L << shift) - 1) >> 1)) >> shift);
+        } else if (sum >= 0) {
+            output[c] = (int16_t)((sum + filter->filled / 2) / filter->filled);
+        } else {
+            output[c] = (int16_t)((sum - filter->filled / 2) / filter->filled);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,122 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Moving average (boxcar) filter with decimation, for smoothing sensor sweeps
+ * on the node before they are sent. Each channel keeps a running sum of its
+ * last @c length inputs, so adding a sweep costs one addition and one
+ * subtraction per channel, and an average is only worked out when a sweep is
+ * output (every @c decimation inputs). With @c length equal to
+ * @c decimation this is a first order CIC decimator.
+ *
+ * Outputs have @c fractionBits fractional bits (e.g. 8 for Q8.8), so the
+ * inputs must be small enough for the averages to still fit in an int16_t.
+ * Averages are rounded to the nearest value, halves away from zero. If
+ * @c length is a power of two, only shifts are used, with the same result.
+ *
+ * Example, averaging 4 sweeps of 48 values and outputting every second one:
+ *   @code
+ *     static int16_t history[48 * 4];
+ *     static int32_t sums[48];
+ *     static boxcar_filterType filter;
+ *     boxcar_init(&filter, history, sums, 48, 4, 2, 0);
+ *     ...
+ *     if (boxcar_add(&filter, values, values)) {
+ *         // values holds the averages
+ *     }
+ *   @endcode
+ *
+ * The same file is used on the nodes and by the host tools in the @e Host
+ * directory. On a PC, @e stdint.h must be included before @e global.h.
+ *
+ * @file boxcar.h
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+
+#ifndef BOXCAR_H
+#define BOXCAR_H
+
+
+/** Largest filter length. **/
+#define BOXCAR_MAX_LENGTH       32
+
+/** Largest number of fractional bits in the outputs. **/
+#define BOXCAR_MAX_FRACTION     8
+
+
+/** State of a filter. **/
+typedef struct {
+    int16_t* history;           /**< Last @c length inputs of each channel. **/
+    int32_t* sums;              /**< Sum of the history of each channel. **/
+    uint8_t channels;           /**< Values in each sweep. **/
+    uint8_t length;             /**< Number of inputs averaged. **/
+    uint8_t decimation;         /**< Inputs for each output. **/
+    uint8_t fractionBits;       /**< Fractional bits in the outputs. **/
+    uint8_t shift;              /**< log2(length), or 0xFF if not a power of 2. **/
+    uint8_t index;              /**< Where the next input goes in history. **/
+    uint8_t filled;             /**< Inputs in history, up to length. **/
+    uint8_t phase;              /**< Inputs since the last output. **/
+} boxcar_filterType;
+
+
+/**
+ * Initialise a filter. Until @a length inputs have been added, the average is
+ * taken over the inputs so far.
+ *
+ * @param filter filter state.
+ * @param history space for @a channels * @a length values.
+ * @param sums space for @a channels sums.
+ * @param channels number of values in each sweep.
+ * @param length number of inputs averaged (1 to BOXCAR_MAX_LENGTH).
+ * @param decimation number of inputs for each output (at least 1).
+ * @param fractionBits fractional bits in the outputs (0 to BOXCAR_MAX_FRACTION).
+ *
+ * @return @c STATUS_OK, or @c STATUS_INVALID_ARG if a parameter is out of
+ *     range.
+ **/
+status_t boxcar_init(boxcar_filterType* filter, int16_t* history, int32_t* sums,
+        uint8_t channels, uint8_t length, uint8_t decimation,
+        uint8_t fractionBits);
+
+
+/**
+ * Add a sweep to the filter, and get the averages if an output is due.
+ *
+ * @param filter filter state.
+ * @param input @c channels values.
+ * @param[out] output @c channels averages. This may be the same as @a input.
+ *     Only written when @c true is returned.
+ *
+ * @return @c true if @a output was written.
+ **/
+bool boxcar_add(boxcar_filterType* filter, const int16_t* input,
+        int16_t* output);
+
+
+#endif
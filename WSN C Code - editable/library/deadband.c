@@ -0,0 +1,122 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Implementation of deadband transmission.
+ *
+ * @file deadband.c
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+#if !defined UC_AVR && !defined UC_8051
+#   include <stdint.h>      /* This file is also used by host tools */
+#endif
+#include "global.h"
+#include "deadband.h"
+
+
+/******************************************************************************\
+ * See deadband.h for documentation of these functions.
+\******************************************************************************/
+
+void deadband_init(deadband_stateType* state, const uint8_t* deadbands,
+        uint16_t keySweeps, uint32_t keyTicks)
+{
+    uint8_t i;
+
+    for (i = 0; i < DEADBAND_CHANNELS * DEADBAND_VALUES_PER_CHANNEL; ++i) {
+        state->values[i] = 0;
+    }
+    state->deadbands = deadbands;
+    state->keySweeps = keySweeps;
+    state->keyTicks = keyTicks;
+    state->sinceKey = 0;
+    state->keyTime = 0;
+    state->hasKey = false;
+}
+
+
+uint16_t deadband_select(deadband_stateType* state, const int16_t* values,
+        uint32_t time)
+{
+    uint16_t mask = 0;
+    uint16_t bit = 0x0001;
+    uint8_t channel, v, i = 0;
+    int16_t change;
+
+    state->sinceKey++;
+    if (!state->hasKey ||
+            (state->keySweeps != 0 && state->sinceKey >= state->keySweeps) ||
+            (state->keyTicks != 0 && time - state->keyTime >= state->keyTicks)) {
+        for (i = 0; i < DEADBAND_CHANNELS * DEADBAND_VALUES_PER_CHANNEL; ++i) {
+            state->values[i] = values[i];
+        }
+        state->sinceKey = 0;
+        state->keyTime = time;
+        state->hasKey = true;
+        return DEADBAND_ALL_CHANNELS;
+    }
+
+    for (channel = 0; channel < DEADBAND_CHANNELS; ++channel) {
+        for (v = 0; v < DEADBAND_VALUES_PER_CHANNEL; ++v) {
+            change = values[i + v] - state->values[i + v];
+            if (change > state->deadbands[channel] ||
+                    change < -(int16_t)state->deadbands[channel]) {
+                mask |= bit;
+            }
+        }
+        if (mask & bit) {
+            for (v = 0; v < DEADBAND_VALUES_PER_CHANNEL; ++v) {
+                state->values[i + v] = values[i + v];
+            }
+        }
+        i += DEADBAND_VALUES_PER_CHANNEL;
+        bit <<= 1;
+    }
+    return mask;
+}
+
+
+void deadband_receive(deadband_stateType* state, uint16_t channelMask,
+        int16_t* values)
+{
+    uint8_t channel, v, i = 0;
+
+    for (channel = 0; channel < DEADBAND_CHANNELS; ++channel) {
+        if (channelMask & (1U << channel)) {
+            for (v = 0; v < DEADBAND_VALUES_PER_CHANNEL; ++v) {
+                state->values[channel * DEADBAND_VALUES_PER_CHANNEL + v] =
+                        values[i++];
+            }
+        }
+    }
+
+    for (i = 0; i < DEADBAND_CHANNELS * DEADBAND_VALUES_PER_CHANNEL; ++i) {
+        values[i] = state->values[i];
+    }
+}
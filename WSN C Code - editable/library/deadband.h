@@ -0,0 +1,124 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Change-threshold (deadband) transmission for sensor sweeps. The sender only
+ * sends the sensors that have moved by more than their deadband since they
+ * were last sent, as a channel mask with the values of those sensors (the
+ * layout used by gloveFrame.h). Every @c keySweeps sweeps, or after
+ * @c keyTicks time ticks, a keyframe with all sensors is sent, so a receiver
+ * that missed a frame catches up.
+ *
+ * The receiver keeps the last value of every sensor and fills in the ones that
+ * were not sent, so it always has a complete sweep.
+ *
+ * Example on the sender:
+ *   @code
+ *     mask = deadband_select(&state, values, time);
+ *     if (mask != 0) {
+ *         // send the sensors in mask
+ *     }
+ *   @endcode
+ *
+ * The same file is used on the nodes and by the host tools in the @e Host
+ * directory. On a PC, @e stdint.h must be included before @e global.h.
+ *
+ * @file deadband.h
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+
+#ifndef DEADBAND_H
+#define DEADBAND_H
+
+
+/** Number of sensors (bits in the channel mask). **/
+#define DEADBAND_CHANNELS       16
+/** Number of values for each sensor. **/
+#define DEADBAND_VALUES_PER_CHANNEL 3
+/** Channel mask of a keyframe. **/
+#define DEADBAND_ALL_CHANNELS   0xFFFF
+
+
+/** State of the sender or receiver of one stream of sweeps. **/
+typedef struct {
+    /** Last values sent or received. **/
+    int16_t values[DEADBAND_CHANNELS * DEADBAND_VALUES_PER_CHANNEL];
+    const uint8_t* deadbands;   /**< Deadband of each sensor (sender only). **/
+    uint16_t keySweeps;         /**< Sweeps between keyframes, 0 = none. **/
+    uint32_t keyTicks;          /**< Time between keyframes, 0 = none. **/
+    uint16_t sinceKey;          /**< Sweeps since the last keyframe. **/
+    uint32_t keyTime;           /**< Time of the last keyframe. **/
+    bool hasKey;                /**< False until the first keyframe. **/
+} deadband_stateType;
+
+
+/**
+ * Initialise the state of a sender or receiver. A sender sends a keyframe
+ * first.
+ *
+ * @param state stream state.
+ * @param deadbands for the sender, the largest change of each of the
+ *     @c DEADBAND_CHANNELS sensors that is not sent (a sensor is sent if any of
+ *     its values has moved by more than this). NULL for a receiver.
+ * @param keySweeps number of sweeps from one keyframe to the next, or 0.
+ * @param keyTicks time from one keyframe to the next, in the units of the
+ *     time given to @c deadband_select(), or 0.
+ **/
+void deadband_init(deadband_stateType* state, const uint8_t* deadbands,
+        uint16_t keySweeps, uint32_t keyTicks);
+
+
+/**
+ * Choose the sensors of a sweep to send, and remember their values as sent.
+ *
+ * @param state sender state.
+ * @param values all values of the sweep.
+ * @param time time of the sweep.
+ *
+ * @return channel mask of the sensors to send, @c DEADBAND_ALL_CHANNELS for a
+ *     keyframe, or 0 if nothing needs to be sent.
+ **/
+uint16_t deadband_select(deadband_stateType* state, const int16_t* values,
+        uint32_t time);
+
+
+/**
+ * Rebuild a complete sweep from a received one.
+ *
+ * @param state receiver state.
+ * @param channelMask sensors in the received sweep.
+ * @param[in,out] values on entry, the values of the sensors in
+ *     @a channelMask, lowest sensor first. On return, all values of the sweep.
+ *     This must have space for all values.
+ **/
+void deadband_receive(deadband_stateType* state, uint16_t channelMask,
+        int16_t* values);
+
+
+#endif
@@ -0,0 +1,149 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Implementation of the fixed-point helpers. Decimal text is made by
+ * subtracting powers of ten, which is much faster than 32-bit division on an
+ * 8-bit microcontroller.
+ *
+ * @file fixedPoint.c
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+#if !defined UC_AVR && !defined UC_8051
+#   include <stdint.h>      /* This file is also used by host tools */
+#   include <stdio.h>
+#endif
+#include "global.h"
+#if defined UC_AVR || defined UC_8051
+#   include "simpleIo.h"
+#endif
+#include "fixedPoint.h"
+
+
+/* Number of decimal digits in the largest uint32_t. */
+#define MAX_DIGITS      10
+
+/* Powers of ten, largest first. */
+static const uint32_t powersOfTen[MAX_DIGITS] = {
+    1000000000UL, 100000000UL, 10000000UL, 1000000UL, 100000UL,
+    10000UL, 1000UL, 100UL, 10UL, 1UL
+};
+
+
+/******************************************************************************\
+ * See fixedPoint.h for documentation of these functions.
+\******************************************************************************/
+
+int32_t fixedPoint_mul(int32_t a, int32_t b, uint8_t fractionBits)
+{
+    return fixedPoint_round(a * b, fractionBits);
+}
+
+
+int32_t fixedPoint_round(int32_t value, uint8_t fractionBits)
+{
+    int32_t half = (int32_t)1 << (fractionBits - 1);
+
+    /* Shifting a negative value rounds down, so work on the magnitude */
+    if (value < 0) {
+        return -((-value + half) >> fractionBits);
+    }
+    return (value + half) >> fractionBits;
+}
+
+
+int16_t fixedPoint_accToMilliG(int16_t raw)
+{
+    /* 1000 / 256 = 125 / 32 */
+    return (int16_t)fixedPoint_round((int32_t)raw * 125, 5);
+}
+
+
+uint16_t fixedPoint_adcToMilliVolts(uint16_t counts,
+        uint16_t referenceMilliVolts, uint8_t bits)
+{
+    return (uint16_t)fixedPoint_round((int32_t)counts * referenceMilliVolts,
+            bits);
+}
+
+
+uint8_t fixedPoint_format(char* buffer, int32_t value, uint8_t decimals)
+{
+    uint32_t magnitude;
+    uint8_t length = 0;
+    uint8_t remaining;
+    uint8_t i;
+    char digit;
+    bool isStarted = false;
+
+    if (decimals > FIXEDPOINT_MAX_DECIMALS) {
+        decimals = FIXEDPOINT_MAX_DECIMALS;
+    }
+    if (value < 0) {
+        buffer[length++] = '-';
+        magnitude = -(uint32_t)value;
+    } else {
+        magnitude = (uint32_t)value;
+    }
+
+    for (i = 0; i < MAX_DIGITS; i++) {
+        digit = '0';
+        while (magnitude >= powersOfTen[i]) {
+            magnitude -= powersOfTen[i];
+            digit++;
+        }
+
+        /* Digits left including this one. Leading zeros are skipped, but
+         * there is always one before the decimal point. */
+        remaining = MAX_DIGITS - i;
+        if (!isStarted && digit == '0' && remaining > decimals + 1) {
+            continue;
+        }
+        isStarted = true;
+        if (remaining == decimals) {
+            buffer[length++] = '.';
+        }
+        buffer[length++] = digit;
+    }
+
+    buffer[length] = '\0';
+    return length;
+}
+
+
+void fixedPoint_put(int32_t value, uint8_t decimals)
+{
+    char text[FIXEDPOINT_FORMAT_SIZE];
+    uint8_t i;
+
+    fixedPoint_format(text, value, decimals);
+    for (i = 0; text[i] != '\0'; i++) {
+        putchar(text[i]);
+    }
+}
@@ -0,0 +1,141 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Fixed-point helpers for sensor values, so that the nodes can scale and print
+ * readings without software floating point. Values are kept as integers in
+ * small units (milli-g, millivolts), or in a Q format with @c fractionBits
+ * fractional bits, and only turned into decimal text when they are printed.
+ *
+ * Example, printing an ADXL345 reading in g and a 10-bit ADC reading in volts:
+ *   @code
+ *     fixedPoint_put(fixedPoint_accToMilliG(raw), 3);                 // "-0.031"
+ *     fixedPoint_put(fixedPoint_adcToMilliVolts(counts, 3300, 10), 3); // "1.650"
+ *   @endcode
+ *
+ * The same file is used on the nodes and by the host tools in the @e Host
+ * directory. On a PC, @e stdint.h must be included before @e global.h.
+ *
+ * @file fixedPoint.h
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+
+#ifndef FIXEDPOINT_H
+#define FIXEDPOINT_H
+
+
+/** Size of the buffer needed by fixedPoint_format() (sign, 10 digits, decimal
+ * point and '\0'). **/
+#define FIXEDPOINT_FORMAT_SIZE      13
+
+/** Largest number of decimals that can be printed. **/
+#define FIXEDPOINT_MAX_DECIMALS     9
+
+/** Q format value of an integer. **/
+#define FIXEDPOINT_FROM_INT(x, fractionBits) \
+        ((int32_t)(x) << (fractionBits))
+
+/** ADXL345 full resolution readings per g (3.9mg/LSB). **/
+#define FIXEDPOINT_ACC_LSB_PER_G    256
+
+
+/**
+ * Multiply two Q format values, rounding the result to the nearest value.
+ *
+ * @param a first value.
+ * @param b second value. The product a * b must fit in an int32_t.
+ * @param fractionBits fractional bits of both values and of the result (at
+ *     least 1).
+ *
+ * @return product, with @c fractionBits fractional bits.
+ **/
+int32_t fixedPoint_mul(int32_t a, int32_t b, uint8_t fractionBits);
+
+
+/**
+ * Round a Q format value to the nearest integer (halves away from zero).
+ *
+ * @param value Q format value.
+ * @param fractionBits fractional bits of @p value (at least 1).
+ *
+ * @return nearest integer.
+ **/
+int32_t fixedPoint_round(int32_t value, uint8_t fractionBits);
+
+
+/**
+ * Convert an ADXL345 full resolution reading to milli-g.
+ *
+ * @param raw reading, as in DATAX0/DATAX1 (256 per g).
+ *
+ * @return acceleration in milli-g, rounded to the nearest.
+ **/
+int16_t fixedPoint_accToMilliG(int16_t raw);
+
+
+/**
+ * Convert an ADC reading to millivolts.
+ *
+ * @param counts ADC reading.
+ * @param referenceMilliVolts ADC reference voltage in millivolts.
+ * @param bits resolution of the ADC (the reference is 2^bits counts).
+ *
+ * @return voltage in millivolts, rounded to the nearest.
+ **/
+uint16_t fixedPoint_adcToMilliVolts(uint16_t counts,
+        uint16_t referenceMilliVolts, uint8_t bits);
+
+
+/**
+ * Write a scaled integer as decimal text. The last @p decimals digits go after
+ * the decimal point, so 1650 with 3 decimals is "1.650" and -31 is "-0.031".
+ * Only subtractions are used, no division.
+ *
+ * @param[out] buffer where to write the text, with space for
+ *     @c FIXEDPOINT_FORMAT_SIZE characters. It is ended with '\0'.
+ * @param value value to write.
+ * @param decimals number of digits after the decimal point (at most
+ *     @c FIXEDPOINT_MAX_DECIMALS, 0 for no decimal point).
+ *
+ * @return number of characters written, not counting the '\0'.
+ **/
+uint8_t fixedPoint_format(char* buffer, int32_t value, uint8_t decimals);
+
+
+/**
+ * Write a scaled integer to the UART with @c putchar(), as for
+ * fixedPoint_format().
+ *
+ * @param value value to write.
+ * @param decimals number of digits after the decimal point.
+ **/
+void fixedPoint_put(int32_t value, uint8_t decimals);
+
+
+#endif
@@ -0,0 +1,120 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Implementation of the gesture classifier.
+ *
+ * @file gesture.c
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+#if !defined UC_AVR && !defined UC_8051
+#   include <stdint.h>      /* This file is also used by host tools */
+#endif
+#include "global.h"
+#include "gesture.h"
+
+
+/******************************************************************************\
+ * See gesture.h for documentation of these functions.
+\******************************************************************************/
+
+uint8_t gesture_classify(const gesture_modelType* model, const int16_t* values)
+{
+    const int8_t* centroid = model->centroids;
+    uint32_t distance, best = UINT32_MAX;
+    uint8_t gesture, bestGesture = 1, i;
+    int16_t difference;
+    uint16_t magnitude;
+
+    for (gesture = 1; gesture <= model->gestureCount; ++gesture) {
+        distance = 0;
+        for (i = 0; i < model->valueCount; ++i) {
+            /* Squared as unsigned, since int is 16 bits on the AVR. Readings
+             * far outside the model are limited to 255 away, so the square
+             * fits in 16 bits. */
+            difference = (values[i] >> model->shift) - GESTURE_READ(centroid);
+            magnitude = (difference < 0) ? -difference : difference;
+            if (magnitude > 255) {
+                magnitude = 255;
+            }
+            distance += (uint16_t)(magnitude * magnitude);
+            centroid++;
+        }
+        if (distance < best) {
+            best = distance;
+            bestGesture = gesture;
+        }
+    }
+    return bestGesture;
+}
+
+
+void gesture_voteInit(gesture_voteType* vote)
+{
+    uint8_t i;
+
+    for (i = 0; i <= GESTURE_MAX_GESTURES; ++i) {
+        vote->counts[i] = 0;
+    }
+    vote->index = 0;
+    vote->filled = 0;
+    vote->current = GESTURE_NONE;
+}
+
+
+uint8_t gesture_vote(gesture_voteType* vote, uint8_t gesture)
+{
+    uint8_t i;
+
+    if (gesture > GESTURE_MAX_GESTURES) {
+        gesture = GESTURE_NONE;
+    }
+
+    if (vote->filled == GESTURE_VOTES) {
+        vote->counts[vote->history[vote->index]]--;
+    } else {
+        vote->filled++;
+    }
+    vote->history[vote->index] = gesture;
+    vote->counts[gesture]++;
+    if (++vote->index == GESTURE_VOTES) {
+        vote->index = 0;
+    }
+
+    if (vote->filled < GESTURE_VOTES) {
+        return GESTURE_NONE;
+    }
+
+    for (i = 0; i <= GESTURE_MAX_GESTURES; ++i) {
+        if (vote->counts[i] > vote->counts[vote->current]) {
+            vote->current = i;
+        }
+    }
+    return vote->current;
+}
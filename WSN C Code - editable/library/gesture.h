@@ -0,0 +1,134 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Nearest-centroid gesture classifier, small enough to run on the glove. Each
+ * known gesture is described by the average accelerometer sweep recorded for
+ * it (its centroid). A sweep is classified as the gesture whose centroid is
+ * closest (smallest squared Euclidean distance), and a majority vote over the
+ * last @c GESTURE_VOTES results stops the gesture changing on a single noisy
+ * sweep, as the PC application does.
+ *
+ * The centroids are generated from the recorded gesture files by
+ * @e Host/gestureExport and compiled in. To keep them small and the maths in
+ * 16 bits, readings are shifted right by @c shift bits (e.g. 5 turns 1/256 g
+ * into 1/8 g) so every centroid value fits in an int8_t. On the AVR they are
+ * kept in flash.
+ *
+ * Gestures are numbered from 1 in the order of @e GestureTypes.dat, the same
+ * as the PC application, and @c GESTURE_NONE is 0.
+ *
+ * The same file is used on the nodes and by the host tools in the @e Host
+ * directory. On a PC, @e stdint.h must be included before @e global.h.
+ *
+ * @file gesture.h
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+
+#ifndef GESTURE_H
+#define GESTURE_H
+
+
+#if defined UC_AVR
+#   include <avr/pgmspace.h>
+/** Put a centroid table in flash. **/
+#   define GESTURE_FLASH            PROGMEM
+/** Read a value from a centroid table. **/
+#   define GESTURE_READ(p)          ((int8_t)pgm_read_byte(p))
+#else
+#   define GESTURE_FLASH
+#   define GESTURE_READ(p)          (*(p))
+#endif
+
+/** No gesture recognised yet. **/
+#define GESTURE_NONE                0
+
+#ifndef GESTURE_MAX_GESTURES
+/** Largest number of gestures in a model. **/
+#   define GESTURE_MAX_GESTURES     8
+#endif
+
+#ifndef GESTURE_VOTES
+/** Number of results in the majority vote. **/
+#   define GESTURE_VOTES            25
+#endif
+
+
+/** A set of gesture centroids. **/
+typedef struct {
+    const int8_t* centroids;    /**< @c valueCount values for each gesture. **/
+    uint8_t gestureCount;       /**< Number of gestures. **/
+    uint8_t valueCount;         /**< Values in each sweep. **/
+    uint8_t shift;              /**< Bits readings are shifted right by. **/
+} gesture_modelType;
+
+
+/** State of a majority vote. **/
+typedef struct {
+    uint8_t history[GESTURE_VOTES]; /**< Last results. **/
+    uint8_t counts[GESTURE_MAX_GESTURES + 1]; /**< Times each is in history. **/
+    uint8_t index;              /**< Where the next result goes. **/
+    uint8_t filled;             /**< Results in history. **/
+    uint8_t current;            /**< Result of the last vote. **/
+} gesture_voteType;
+
+
+/**
+ * Find the gesture whose centroid is closest to a sweep.
+ *
+ * @param model gesture centroids.
+ * @param values @c valueCount raw readings.
+ *
+ * @return gesture number (1 to @c gestureCount).
+ **/
+uint8_t gesture_classify(const gesture_modelType* model, const int16_t* values);
+
+
+/**
+ * Initialise a majority vote.
+ *
+ * @param vote vote state.
+ **/
+void gesture_voteInit(gesture_voteType* vote);
+
+
+/**
+ * Add a result to a majority vote.
+ *
+ * @param vote vote state.
+ * @param gesture result of @c gesture_classify().
+ *
+ * @return most common gesture in the last @c GESTURE_VOTES results, or
+ *     @c GESTURE_NONE until that many have been added. On a tie the previous
+ *     result is kept if it is one of the most common.
+ **/
+uint8_t gesture_vote(gesture_voteType* vote, uint8_t gesture);
+
+
+#endif
@@ -0,0 +1,382 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Implementation of the glove frame functions. Values are copied a byte at a
+ * time, so the frame does not need to be aligned and the byte order does not
+ * depend on the processor.
+ *
+ * @file gloveFrame.c
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+#if !defined UC_AVR && !defined UC_8051
+#   include <stdint.h>      /* This file is also used by host tools */
+#endif
+#include "global.h"
+#include "gloveFrame.h"
+
+
+/* Offset of the channel mask in the header. */
+#define MASK_OFFSET     9
+
+
+/******************************************************************************\
+ * See gloveFrame.h for documentation of these functions.
+\******************************************************************************/
+
+uint8_t gloveFrame_countChannels(uint16_t channelMask)
+{
+    uint8_t count = 0;
+
+    while (channelMask != 0) {
+        channelMask &= channelMask - 1;     /* Clear lowest bit that is set */
+        count++;
+    }
+    return count;
+}
+
+
+uint8_t gloveFrame_writeHeader(uint8_t* frame, uint8_t type, uint8_t seq,
+        uint32_t time, uint16_t span, uint16_t channelMask)
+{
+    frame[0] = GLOVEFRAME_VERSION;
+    frame[1] = type;
+    frame[2] = seq;
+    frame[3] = BYTE_0(time);
+    frame[4] = BYTE_1(time);
+    frame[5] = BYTE_2(time);
+    frame[6] = BYTE_3(time);
+    frame[7] = LOW_BYTE(span);
+    frame[8] = HIGH_BYTE(span);
+    frame[MASK_OFFSET] = LOW_BYTE(channelMask);
+    frame[MASK_OFFSET + 1] = HIGH_BYTE(channelMask);
+
+    return GLOVEFRAME_SIZE(gloveFrame_countChannels(channelMask));
+}
+
+
+status_t gloveFrame_readHeader(const uint8_t* frame, uint8_t length,
+        gloveFrame_headerType* header)
+{
+    if (length < GLOVEFRAME_HEADER_SIZE || frame[0] != GLOVEFRAME_VERSION) {
+        return STATUS_INVALID_ARG;
+    }
+
+    header->version = frame[0];
+    header->type = frame[1];
+    header->seq = frame[2];
+    header->time = TO_UINT32(frame[6], frame[5], frame[4], frame[3]);
+    header->span = TO_UINT16(frame[8], frame[7]);
+    header->channelMask = TO_UINT16(frame[MASK_OFFSET + 1], frame[MASK_OFFSET]);
+
+    if (length < GLOVEFRAME_SIZE(gloveFrame_countChannels(header->channelMask))) {
+        return STATUS_INVALID_ARG;
+    }
+    if (header->type == GLOVEFRAME_TYPE_GESTURE &&
+            length < GLOVEFRAME_GESTURE_SIZE) {
+        return STATUS_INVALID_ARG;
+    }
+    if (header->type == GLOVEFRAME_TYPE_SETTLE &&
+            length < GLOVEFRAME_SETTLE_SIZE) {
+        return STATUS_INVALID_ARG;
+    }
+    if (header->type == GLOVEFRAME_TYPE_RATE &&
+            length < GLOVEFRAME_RATE_SIZE) {
+        return STATUS_INVALID_ARG;
+    }
+    if (header->type == GLOVEFRAME_TYPE_PACKED &&
+            length < GLOVEFRAME_PACKED_SIZE) {
+        return STATUS_INVALID_ARG;
+    }
+    if (header->type == GLOVEFRAME_TYPE_BEACON &&
+            (length < GLOVEFRAME_BEACON_SIZE(0) ||
+             frame[GLOVEFRAME_BEACON_OFFSET + 2] > GLOVEFRAME_MAX_SLOTS ||
+             length < GLOVEFRAME_BEACON_SIZE(
+                     frame[GLOVEFRAME_BEACON_OFFSET + 2]))) {
+        return STATUS_INVALID_ARG;
+    }
+    return STATUS_OK;
+}
+
+
+uint8_t gloveFrame_compact(uint8_t* frame, uint16_t channelMask)
+{
+    uint16_t oldMask = TO_UINT16(frame[MASK_OFFSET + 1], frame[MASK_OFFSET]);
+    uint16_t bit;
+    uint8_t from = 0, to = 0, v;
+
+    channelMask &= oldMask;
+    for (bit = 0x0001; bit != 0; bit <<= 1) {
+        if (!(oldMask & bit)) {
+            continue;
+        }
+        if (channelMask & bit) {
+            for (v = 0; v < GLOVEFRAME_VALUES_PER_CHANNEL; ++v) {
+                gloveFrame_setValue(frame, to + v,
+                        gloveFrame_getValue(frame, from + v));
+            }
+            to += GLOVEFRAME_VALUES_PER_CHANNEL;
+        }
+        from += GLOVEFRAME_VALUES_PER_CHANNEL;
+    }
+
+    frame[MASK_OFFSET] = LOW_BYTE(channelMask);
+    frame[MASK_OFFSET + 1] = HIGH_BYTE(channelMask);
+    return GLOVEFRAME_SIZE(gloveFrame_countChannels(channelMask));
+}
+
+
+uint8_t gloveFrame_writeGesture(uint8_t* frame, uint8_t seq, uint32_t time,
+        uint8_t gesture)
+{
+    gloveFrame_writeHeader(frame, GLOVEFRAME_TYPE_GESTURE, seq, time, 0, 0);
+    frame[GLOVEFRAME_GESTURE_OFFSET] = gesture;
+    return GLOVEFRAME_GESTURE_SIZE;
+}
+
+
+uint8_t gloveFrame_writeRate(uint8_t* frame, uint8_t type, uint16_t rate)
+{
+    gloveFrame_writeHeader(frame, GLOVEFRAME_TYPE_RATE, 0, 0, 0, 0);
+    frame[GLOVEFRAME_RATE_OFFSET] = type;
+    frame[GLOVEFRAME_RATE_OFFSET + 1] = LOW_BYTE(rate);
+    frame[GLOVEFRAME_RATE_OFFSET + 2] = HIGH_BYTE(rate);
+    return GLOVEFRAME_RATE_SIZE;
+}
+
+
+status_t gloveFrame_readRate(const uint8_t* frame, uint8_t length,
+        uint8_t* type, uint16_t* rate)
+{
+    gloveFrame_headerType header;
+
+    if (gloveFrame_readHeader(frame, length, &header) != STATUS_OK ||
+            header.type != GLOVEFRAME_TYPE_RATE) {
+        return STATUS_INVALID_ARG;
+    }
+
+    *type = frame[GLOVEFRAME_RATE_OFFSET];
+    *rate = TO_UINT16(frame[GLOVEFRAME_RATE_OFFSET + 2],
+            frame[GLOVEFRAME_RATE_OFFSET + 1]);
+    return STATUS_OK;
+}
+
+
+uint8_t gloveFrame_writeBeacon(uint8_t* frame, uint8_t seq, uint32_t time,
+        uint16_t slotLength, uint8_t slotCount, const uint16_t* addresses)
+{
+    uint8_t* slots = frame + GLOVEFRAME_BEACON_OFFSET + 3;
+    uint8_t n;
+
+    gloveFrame_writeHeader(frame, GLOVEFRAME_TYPE_BEACON, seq, time, 0, 0);
+    frame[GLOVEFRAME_BEACON_OFFSET] = LOW_BYTE(slotLength);
+    frame[GLOVEFRAME_BEACON_OFFSET + 1] = HIGH_BYTE(slotLength);
+    frame[GLOVEFRAME_BEACON_OFFSET + 2] = slotCount;
+    for (n = 0; n < slotCount; ++n) {
+        slots[2 * n] = LOW_BYTE(addresses[n]);
+        slots[2 * n + 1] = HIGH_BYTE(addresses[n]);
+    }
+    return GLOVEFRAME_BEACON_SIZE(slotCount);
+}
+
+
+status_t gloveFrame_readBeacon(const uint8_t* frame, uint8_t length,
+        uint16_t address, uint16_t* slotLength, uint8_t* slotCount,
+        uint8_t* slot)
+{
+    gloveFrame_headerType header;
+    const uint8_t* slots = frame + GLOVEFRAME_BEACON_OFFSET + 3;
+    uint8_t n;
+
+    if (gloveFrame_readHeader(frame, length, &header) != STATUS_OK ||
+            header.type != GLOVEFRAME_TYPE_BEACON) {
+        return STATUS_INVALID_ARG;
+    }
+
+    *slotLength = TO_UINT16(frame[GLOVEFRAME_BEACON_OFFSET + 1],
+            frame[GLOVEFRAME_BEACON_OFFSET]);
+    *slotCount = frame[GLOVEFRAME_BEACON_OFFSET + 2];
+    *slot = GLOVEFRAME_NO_SLOT;
+    for (n = 0; n < *slotCount; ++n) {
+        if (TO_UINT16(slots[2 * n + 1], slots[2 * n]) == address) {
+            *slot = n;
+            break;
+        }
+    }
+    return STATUS_OK;
+}
+
+
+uint8_t gloveFrame_writeSettle(uint8_t* frame, uint8_t seq, uint32_t time,
+        const uint8_t* settle)
+{
+    uint8_t i;
+
+    gloveFrame_writeHeader(frame, GLOVEFRAME_TYPE_SETTLE, seq, time, 0, 0);
+    for (i = 0; i < GLOVEFRAME_CHANNELS * GLOVEFRAME_VALUES_PER_CHANNEL; ++i) {
+        frame[GLOVEFRAME_SETTLE_OFFSET + i] = settle[i];
+    }
+    return GLOVEFRAME_SETTLE_SIZE;
+}
+
+
+uint16_t gloveFrame_bendOffset(const uint8_t* settle, uint8_t index,
+        uint16_t span)
+{
+    /* The span ends when the last mux position starts */
+    const uint8_t lastStep =
+            (GLOVEFRAME_CHANNELS - 1) * GLOVEFRAME_VALUES_PER_CHANNEL;
+    uint16_t conversions = 0;
+    uint16_t toValue = 0;
+    uint16_t toLastStep = 0;
+    uint8_t i;
+
+    for (i = 0; i < GLOVEFRAME_CHANNELS * GLOVEFRAME_VALUES_PER_CHANNEL; ++i) {
+        if (i == index) {
+            toValue = conversions + settle[i];
+        }
+        if (i == lastStep) {
+            toLastStep = conversions;
+        }
+        conversions += settle[i] + 1;
+    }
+    return (uint32_t)span * toValue / toLastStep;
+}
+
+
+uint8_t gloveFrame_writePacked(uint8_t* frame, uint8_t type, uint8_t seq,
+        uint32_t time)
+{
+    gloveFrame_writeHeader(frame, GLOVEFRAME_TYPE_PACKED, seq, time, 0, 0);
+    frame[GLOVEFRAME_PACKED_OFFSET] = type;
+    return GLOVEFRAME_PACKED_SIZE;
+}
+
+
+uint8_t gloveFrame_addSweep(uint8_t* frame, uint8_t length, uint8_t maxLength,
+        uint8_t seq, uint32_t time, uint16_t span, const uint8_t* block,
+        uint8_t size)
+{
+    uint32_t offset = time - TO_UINT32(frame[6], frame[5], frame[4], frame[3]);
+    uint8_t* sweep = frame + length;
+    uint8_t i;
+
+    if (offset > 0xFFFF ||
+            length + GLOVEFRAME_SWEEP_HEADER_SIZE + size > maxLength) {
+        return 0;
+    }
+
+    sweep[0] = seq;
+    sweep[1] = LOW_BYTE(offset);
+    sweep[2] = HIGH_BYTE(offset);
+    sweep[3] = LOW_BYTE(span);
+    sweep[4] = HIGH_BYTE(span);
+    sweep += GLOVEFRAME_SWEEP_HEADER_SIZE;
+    for (i = 0; i < size; ++i) {
+        sweep[i] = block[i];
+    }
+    return length + GLOVEFRAME_SWEEP_HEADER_SIZE + size;
+}
+
+
+status_t gloveFrame_readSweep(const uint8_t* frame, uint8_t length,
+        uint8_t* offset, sweepCodec_stateType* codec,
+        gloveFrame_headerType* header, int16_t* values)
+{
+    const uint8_t* sweep = frame + *offset;
+    uint8_t size;
+    status_t status;
+
+    if (*offset + GLOVEFRAME_SWEEP_HEADER_SIZE > length) {
+        return STATUS_INVALID_ARG;
+    }
+
+    header->version = frame[0];
+    header->type = frame[GLOVEFRAME_PACKED_OFFSET];
+    header->seq = sweep[0];
+    header->time = TO_UINT32(frame[6], frame[5], frame[4], frame[3]) +
+            TO_UINT16(sweep[2], sweep[1]);
+    header->span = TO_UINT16(sweep[4], sweep[3]);
+    header->channelMask = GLOVEFRAME_ALL_CHANNELS;
+
+    status = sweepCodec_decode(codec, sweep + GLOVEFRAME_SWEEP_HEADER_SIZE,
+            length - *offset - GLOVEFRAME_SWEEP_HEADER_SIZE, values, &size);
+    if (status != STATUS_INVALID_ARG) {
+        *offset += GLOVEFRAME_SWEEP_HEADER_SIZE + size;
+    }
+    return status;
+}
+
+
+void gloveFrame_setValue(uint8_t* frame, uint8_t index, int16_t value)
+{
+    frame += GLOVEFRAME_VALUE_OFFSET(index);
+    frame[0] = LOW_BYTE(value);
+    frame[1] = HIGH_BYTE(value);
+}
+
+
+int16_t gloveFrame_getValue(const uint8_t* frame, uint8_t index)
+{
+    frame += GLOVEFRAME_VALUE_OFFSET(index);
+    return (int16_t)TO_UINT16(frame[1], frame[0]);
+}
+
+
+uint8_t gloveFrame_encode(uint8_t* frame, uint8_t type, uint8_t seq,
+        uint32_t time, uint16_t span, uint16_t channelMask,
+        const int16_t* values)
+{
+    uint8_t size, count, i;
+
+    size = gloveFrame_writeHeader(frame, type, seq, time, span, channelMask);
+    count = gloveFrame_countChannels(channelMask) * GLOVEFRAME_VALUES_PER_CHANNEL;
+    for (i = 0; i < count; ++i) {
+        gloveFrame_setValue(frame, i, values[i]);
+    }
+    return size;
+}
+
+
+status_t gloveFrame_decode(const uint8_t* frame, uint8_t length,
+        gloveFrame_headerType* header, int16_t* values)
+{
+    uint8_t count, i;
+
+    if (gloveFrame_readHeader(frame, length, header) != STATUS_OK) {
+        return STATUS_INVALID_ARG;
+    }
+
+    count = gloveFrame_countChannels(header->channelMask) *
+            GLOVEFRAME_VALUES_PER_CHANNEL;
+    for (i = 0; i < count; ++i) {
+        values[i] = gloveFrame_getValue(frame, i);
+    }
+    return STATUS_OK;
+}
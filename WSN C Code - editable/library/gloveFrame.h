@@ -0,0 +1,494 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Layout of the radio frames sent by the glove, with functions to write and
+ * read them. The glove, the base station and the PC tools in the @e Host
+ * directory all use this file, so the layout is only defined here.
+ *
+ * Frame layout (multi-byte fields are little endian):
+ * @verbatim
+       <version:8><type:8><seq:8><time:32><span:16><channelMask:16><value:16 x N>
+
+           version     = GLOVEFRAME_VERSION, changed whenever the layout is
+           type        = what the values are (see GLOVEFRAME_TYPE_xxx)
+           seq         = sweep sequence number. Accelerometer and bend sensor
+                         sweeps are counted separately, as they can run at
+                         different rates.
+           time        = time the sweep started, in microseconds (see
+                         sampler.h). A glove built with GLOVE_TIME_SYNC
+                         gives it in the base station's time.
+           span        = microseconds from reading the first sensor of the
+                         sweep to reading the last
+           channelMask = which of the 16 sensors are in the frame (bit 0 is
+                         sensor 0)
+           value       = GLOVEFRAME_VALUES_PER_CHANNEL values for each sensor
+                         in channelMask, lowest sensor first@endverbatim
+ *
+ * Accelerometers are read one after the other at even intervals, so
+ * accelerometer c (counting from 0, whether or not it is in the channel mask)
+ * was read at time + c * span / (GLOVEFRAME_CHANNELS - 1).
+ *
+ * Bend values are not evenly spaced. The ADC converts them one after the
+ * other, and before each reading it does a number of throw-away settling
+ * conversions that the glove sets per reading (see adc_avr.h). The settle
+ * count can differ between the channels of one mux position, and it changes
+ * when the glove is calibrated. The span of a bend sweep runs from the first
+ * conversion to the first conversion at the last mux position. The glove
+ * sends its settle table in settle frames, and @c gloveFrame_bendOffset()
+ * gives the time of each reading from the table and the span.
+ *
+ * Accelerometer values are the raw ADXL345 readings (x, y, z). Bend values are
+ * the raw 10-bit ADC readings of ADC2, ADC1 and ADC3 at each mux position.
+ *
+ * Gesture frames (see gesture.h) have no sensors in the channel mask and carry
+ * one byte after the header, the number of the gesture recognised.
+ *
+ * Settle frames are sent by the glove at start-up and then now and again.
+ * They have no sensors in the channel mask, and after the header they carry
+ * the number of settling conversions before each bend reading, one byte for
+ * each of the GLOVEFRAME_CHANNELS * GLOVEFRAME_VALUES_PER_CHANNEL values in
+ * frame order.
+ *
+ * Rate frames are sent to the glove to change how often one type of frame is
+ * sampled. They have no sensors in the channel mask and carry the type of frame
+ * (one byte) and the new number of sweeps per second (16 bits) after the
+ * header.
+ *
+ * Beacon frames are broadcast by the base station to share the channel
+ * between gloves by time division. They have no sensors in the channel mask,
+ * the time field holds the base station's time when the previous beacon was
+ * sent (its start of frame delimiter), and after the header they carry:
+ * @verbatim
+       <slotLength:16><slotCount:8><address:16 x slotCount>@endverbatim
+ * Each beacon starts a superframe of slotCount + 1 slots of slotLength
+ * microseconds, the first of which holds the beacon. Slot n (counting from 0)
+ * of the list is for the glove with the given radio address, and starts
+ * n * slotLength microseconds after the end of the beacon.
+ *
+ * Packed frames carry several sweeps of one type, each compressed with
+ * @e sweepCodec.h against the sweep before it, to make fewer and fuller radio
+ * packets. They have no sensors in the channel mask, their sequence number
+ * counts the packed frames of that type (so a receiver can tell when one is
+ * lost and reset its codec), and the time is that of the first sweep. After
+ * the header they carry:
+ * @verbatim
+       <sweepType:8><sweep x N>
+
+           sweep = <seq:8><timeOffset:16><span:16><block>
+
+           sweepType  = type of the sweeps (GLOVEFRAME_TYPE_ACC or
+                        GLOVEFRAME_TYPE_BEND)
+           seq, span  = as in the header of a single sweep
+           timeOffset = microseconds from the time in the header
+           block      = all values of the sweep, coded with sweepCodec.h@endverbatim
+ *
+ * Sync frames are broadcast by the base station so that the gloves can keep
+ * to its time (see timeSync.h). They are only a header. The time is when the
+ * sync frame before it (sequence number seq - 1) was sent, as the radio
+ * timestamps a frame at its start frame delimiter as it goes out (see
+ * rf_getTxTime()), and a glove pairs it with the timestamp of that frame's
+ * arrival. Beacon frames carry the time in the same way.
+ *
+ * On a PC, @e stdint.h must be included before @e global.h.
+ *
+ * @file gloveFrame.h
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+
+#ifndef GLOVEFRAME_H
+#define GLOVEFRAME_H
+
+#include "sweepCodec.h"
+
+
+/** Version of the frame layout. Frames with another version are rejected. **/
+#define GLOVEFRAME_VERSION              2
+
+/** Frame of accelerometer values. **/
+#define GLOVEFRAME_TYPE_ACC             'A'
+/** Frame of bend sensor values. **/
+#define GLOVEFRAME_TYPE_BEND            'B'
+/** Frame with the gesture recognised by the glove. **/
+#define GLOVEFRAME_TYPE_GESTURE         'G'
+/** Frame asking the glove to change a sweep rate. **/
+#define GLOVEFRAME_TYPE_RATE            'R'
+/** Frame assigning transmit slots to gloves. **/
+#define GLOVEFRAME_TYPE_BEACON          'T'
+/** Frame with the base station's time. **/
+#define GLOVEFRAME_TYPE_SYNC            'S'
+/** Frame with the glove's bend settle table. **/
+#define GLOVEFRAME_TYPE_SETTLE          'L'
+/** Frame of several compressed sweeps. **/
+#define GLOVEFRAME_TYPE_PACKED          'P'
+
+/** Number of sensors (bits in the channel mask). **/
+#define GLOVEFRAME_CHANNELS             16
+/** Number of values for each sensor. **/
+#define GLOVEFRAME_VALUES_PER_CHANNEL   3
+/** Channel mask with all sensors included. **/
+#define GLOVEFRAME_ALL_CHANNELS         0xFFFF
+
+/** Number of bytes before the values. **/
+#define GLOVEFRAME_HEADER_SIZE          11
+
+/** Size in bytes of a frame holding @c n sensors. **/
+#define GLOVEFRAME_SIZE(n) \
+        (GLOVEFRAME_HEADER_SIZE + 2 * GLOVEFRAME_VALUES_PER_CHANNEL * (n))
+
+/** Offset in the frame of value number @c i (counting from 0). **/
+#define GLOVEFRAME_VALUE_OFFSET(i)      (GLOVEFRAME_HEADER_SIZE + 2 * (i))
+
+/** Offset of the gesture number in a gesture frame. **/
+#define GLOVEFRAME_GESTURE_OFFSET       GLOVEFRAME_HEADER_SIZE
+/** Size in bytes of a gesture frame. **/
+#define GLOVEFRAME_GESTURE_SIZE         (GLOVEFRAME_HEADER_SIZE + 1)
+
+/** Offset of the settle table in a settle frame. **/
+#define GLOVEFRAME_SETTLE_OFFSET        GLOVEFRAME_HEADER_SIZE
+/** Size in bytes of a settle frame. **/
+#define GLOVEFRAME_SETTLE_SIZE \
+        (GLOVEFRAME_HEADER_SIZE + GLOVEFRAME_CHANNELS * GLOVEFRAME_VALUES_PER_CHANNEL)
+
+/** Offset of the frame type in a rate frame (the rate follows it). **/
+#define GLOVEFRAME_RATE_OFFSET          GLOVEFRAME_HEADER_SIZE
+/** Size in bytes of a rate frame. **/
+#define GLOVEFRAME_RATE_SIZE            (GLOVEFRAME_HEADER_SIZE + 3)
+
+/** Offset of the type of the sweeps in a packed frame. **/
+#define GLOVEFRAME_PACKED_OFFSET        GLOVEFRAME_HEADER_SIZE
+/** Size in bytes of a packed frame before the first sweep. **/
+#define GLOVEFRAME_PACKED_SIZE          (GLOVEFRAME_HEADER_SIZE + 1)
+/** Bytes before the block of each sweep in a packed frame. **/
+#define GLOVEFRAME_SWEEP_HEADER_SIZE    5
+
+/** Offset of the slot length in a beacon frame (the slot count and the
+ * addresses follow it). **/
+#define GLOVEFRAME_BEACON_OFFSET        GLOVEFRAME_HEADER_SIZE
+/** Most slots a beacon frame can assign. **/
+#define GLOVEFRAME_MAX_SLOTS            8
+/** Size in bytes of a beacon frame assigning @c n slots. **/
+#define GLOVEFRAME_BEACON_SIZE(n)       (GLOVEFRAME_HEADER_SIZE + 3 + 2 * (n))
+/** Slot returned by @c gloveFrame_readBeacon() for an address not in the
+ * beacon. **/
+#define GLOVEFRAME_NO_SLOT              0xFF
+
+
+/** Header fields of a frame. **/
+typedef struct {
+    uint8_t version;            /**< Layout version. **/
+    uint8_t type;               /**< Type of values. **/
+    uint8_t seq;                /**< Sweep sequence number. **/
+    uint32_t time;              /**< Time of the sweep (us). **/
+    uint16_t span;              /**< Time to read all sensors (us). **/
+    uint16_t channelMask;       /**< Sensors in the frame. **/
+} gloveFrame_headerType;
+
+
+/**
+ * Count the sensors in a channel mask.
+ *
+ * @param channelMask channel mask.
+ *
+ * @return number of bits set.
+ **/
+uint8_t gloveFrame_countChannels(uint16_t channelMask);
+
+
+/**
+ * Write the header of a frame. The values can then be written with
+ * @c gloveFrame_setValue(), or directly at @c GLOVEFRAME_VALUE_OFFSET().
+ *
+ * @param frame where to write the header.
+ * @param type type of frame.
+ * @param seq sweep sequence number.
+ * @param time time of the sweep in microseconds.
+ * @param span microseconds from reading the first sensor to the last.
+ * @param channelMask sensors that will be in the frame.
+ *
+ * @return size of the complete frame in bytes.
+ **/
+uint8_t gloveFrame_writeHeader(uint8_t* frame, uint8_t type, uint8_t seq,
+        uint32_t time, uint16_t span, uint16_t channelMask);
+
+
+/**
+ * Read and check the header of a received frame.
+ *
+ * @param frame received frame.
+ * @param length number of bytes received.
+ * @param[out] header header fields.
+ *
+ * @return @c STATUS_OK, or @c STATUS_INVALID_ARG if the version is not
+ *     @c GLOVEFRAME_VERSION or the frame is too short for its channel mask (or
+ *     for the fields after the header of a gesture, rate, beacon or packed
+ *     frame).
+ **/
+status_t gloveFrame_readHeader(const uint8_t* frame, uint8_t length,
+        gloveFrame_headerType* header);
+
+
+/**
+ * Remove sensors from a frame, moving the values of the others down.
+ *
+ * @param frame frame to change.
+ * @param channelMask sensors to keep. Sensors not already in the frame are
+ *     ignored.
+ *
+ * @return new size of the frame in bytes.
+ **/
+uint8_t gloveFrame_compact(uint8_t* frame, uint16_t channelMask);
+
+
+/**
+ * Write a complete gesture frame.
+ *
+ * @param frame where to write the frame (GLOVEFRAME_GESTURE_SIZE bytes).
+ * @param seq sweep sequence number.
+ * @param time time of the sweep in microseconds.
+ * @param gesture gesture number.
+ *
+ * @return size of the frame in bytes.
+ **/
+uint8_t gloveFrame_writeGesture(uint8_t* frame, uint8_t seq, uint32_t time,
+        uint8_t gesture);
+
+
+/**
+ * Write a complete rate frame.
+ *
+ * @param frame where to write the frame (GLOVEFRAME_RATE_SIZE bytes).
+ * @param type type of the frames whose sweep rate is changed.
+ * @param rate new number of sweeps per second.
+ *
+ * @return size of the frame in bytes.
+ **/
+uint8_t gloveFrame_writeRate(uint8_t* frame, uint8_t type, uint16_t rate);
+
+
+/**
+ * Read a rate frame.
+ *
+ * @param frame received frame.
+ * @param length number of bytes received.
+ * @param[out] type type of the frames whose sweep rate is changed.
+ * @param[out] rate new number of sweeps per second.
+ *
+ * @return @c STATUS_OK, or @c STATUS_INVALID_ARG if this is not a valid rate
+ *     frame.
+ **/
+status_t gloveFrame_readRate(const uint8_t* frame, uint8_t length,
+        uint8_t* type, uint16_t* rate);
+
+
+/**
+ * Write a complete beacon frame.
+ *
+ * @param frame where to write the frame (@c GLOVEFRAME_BEACON_SIZE(slotCount)
+ *     bytes).
+ * @param seq beacon sequence number.
+ * @param time time the previous beacon was sent in microseconds.
+ * @param slotLength length of each slot in microseconds.
+ * @param slotCount number of slots, no more than @c GLOVEFRAME_MAX_SLOTS.
+ * @param addresses radio address of the glove in each slot.
+ *
+ * @return size of the frame in bytes.
+ **/
+uint8_t gloveFrame_writeBeacon(uint8_t* frame, uint8_t seq, uint32_t time,
+        uint16_t slotLength, uint8_t slotCount, const uint16_t* addresses);
+
+
+/**
+ * Read a beacon frame, and find the slot of one glove.
+ *
+ * @param frame received frame.
+ * @param length number of bytes received.
+ * @param address radio address of the glove.
+ * @param[out] slotLength length of each slot in microseconds.
+ * @param[out] slotCount number of slots.
+ * @param[out] slot slot of the glove (counting from 0), or
+ *     @c GLOVEFRAME_NO_SLOT if the beacon does not give it one.
+ *
+ * @return @c STATUS_OK, or @c STATUS_INVALID_ARG if this is not a valid beacon
+ *     frame.
+ **/
+status_t gloveFrame_readBeacon(const uint8_t* frame, uint8_t length,
+        uint16_t address, uint16_t* slotLength, uint8_t* slotCount,
+        uint8_t* slot);
+
+
+/**
+ * Write a complete settle frame.
+ *
+ * @param frame where to write the frame (GLOVEFRAME_SETTLE_SIZE bytes).
+ * @param seq sweep sequence number.
+ * @param time time of the sweep in microseconds.
+ * @param settle settling conversions before each bend reading, in frame
+ *     order.
+ *
+ * @return size of the frame in bytes.
+ **/
+uint8_t gloveFrame_writeSettle(uint8_t* frame, uint8_t seq, uint32_t time,
+        const uint8_t* settle);
+
+
+/**
+ * Time at which a bend value was read, counting the ADC conversions before it.
+ *
+ * @param settle settle table from a settle frame.
+ * @param index number of the value in the frame (counting from 0, whether or
+ *     not its sensor is in the channel mask).
+ * @param span span of the bend frame.
+ *
+ * @return microseconds from the time of the frame to the start of the
+ *     conversion that gave the value.
+ **/
+uint16_t gloveFrame_bendOffset(const uint8_t* settle, uint8_t index,
+        uint16_t span);
+
+
+/**
+ * Start a packed frame, with no sweeps.
+ *
+ * @param frame where to write the frame.
+ * @param type type of the sweeps.
+ * @param seq number of this packed frame among those of the same type.
+ * @param time time of the first sweep in microseconds.
+ *
+ * @return size of the frame in bytes (@c GLOVEFRAME_PACKED_SIZE).
+ **/
+uint8_t gloveFrame_writePacked(uint8_t* frame, uint8_t type, uint8_t seq,
+        uint32_t time);
+
+
+/**
+ * Add a sweep to a packed frame.
+ *
+ * @param frame packed frame.
+ * @param length size of the frame in bytes so far.
+ * @param maxLength largest size the frame can grow to.
+ * @param seq sweep sequence number.
+ * @param time time of the sweep in microseconds, no more than 65535 after the
+ *     time of the frame.
+ * @param span microseconds from reading the first sensor to the last.
+ * @param block the sweep coded with @c sweepCodec_encode().
+ * @param size size of @p block in bytes.
+ *
+ * @return new size of the frame, or 0 if the sweep does not fit in
+ *     @p maxLength or is too late (the frame is not changed).
+ **/
+uint8_t gloveFrame_addSweep(uint8_t* frame, uint8_t length, uint8_t maxLength,
+        uint8_t seq, uint32_t time, uint16_t span, const uint8_t* block,
+        uint8_t size);
+
+
+/**
+ * Read the next sweep of a packed frame. Sweeps must be read in order, and
+ * from every packed frame of that type, for the codec to follow them.
+ *
+ * @param frame received frame, checked with @c gloveFrame_readHeader().
+ * @param length number of bytes received.
+ * @param[in,out] offset where the sweep starts, @c GLOVEFRAME_PACKED_SIZE for
+ *     the first. Moved on to the next sweep unless @c STATUS_INVALID_ARG is
+ *     returned. The last sweep has been read when it reaches @p length.
+ * @param codec decoder for sweeps of this type, set up for
+ *     @c GLOVEFRAME_CHANNELS * @c GLOVEFRAME_VALUES_PER_CHANNEL values.
+ * @param[out] header header fields of the sweep, as if it had been sent in a
+ *     frame of its own with all sensors.
+ * @param[out] values values of the sweep.
+ *
+ * @return @c STATUS_OK, @c STATUS_INVALID_ARG if the sweep is cut short or
+ *     can't be decoded, or @c STATUS_COMM_ERROR if it needs a keyframe that
+ *     was lost (see @c sweepCodec_decode()).
+ **/
+status_t gloveFrame_readSweep(const uint8_t* frame, uint8_t length,
+        uint8_t* offset, sweepCodec_stateType* codec,
+        gloveFrame_headerType* header, int16_t* values);
+
+
+/**
+ * Write one value of a frame.
+ *
+ * @param frame frame to write to.
+ * @param index number of the value (counting from 0).
+ * @param value value to write.
+ **/
+void gloveFrame_setValue(uint8_t* frame, uint8_t index, int16_t value);
+
+
+/**
+ * Read one value of a frame.
+ *
+ * @param frame frame to read from.
+ * @param index number of the value (counting from 0).
+ *
+ * @return value.
+ **/
+int16_t gloveFrame_getValue(const uint8_t* frame, uint8_t index);
+
+
+/**
+ * Write a complete frame.
+ *
+ * @param frame where to write the frame. This must have space for
+ *     @c GLOVEFRAME_SIZE(n) bytes, where n is the number of sensors in
+ *     @a channelMask.
+ * @param type type of frame.
+ * @param seq sweep sequence number.
+ * @param time time of the sweep in microseconds.
+ * @param span microseconds from reading the first sensor to the last.
+ * @param channelMask sensors in the frame.
+ * @param values @c GLOVEFRAME_VALUES_PER_CHANNEL values for each sensor in
+ *     @a channelMask.
+ *
+ * @return size of the frame in bytes.
+ **/
+uint8_t gloveFrame_encode(uint8_t* frame, uint8_t type, uint8_t seq,
+        uint32_t time, uint16_t span, uint16_t channelMask,
+        const int16_t* values);
+
+
+/**
+ * Read a complete frame.
+ *
+ * @param frame received frame.
+ * @param length number of bytes received.
+ * @param[out] header header fields.
+ * @param[out] values values of each sensor in the channel mask. This must have
+ *     space for @c GLOVEFRAME_CHANNELS * @c GLOVEFRAME_VALUES_PER_CHANNEL
+ *     values.
+ *
+ * @return @c STATUS_OK or @c STATUS_INVALID_ARG (see
+ *     @c gloveFrame_readHeader()).
+ **/
+status_t gloveFrame_decode(const uint8_t* frame, uint8_t length,
+        gloveFrame_headerType* header, int16_t* values);
+
+
+#endif
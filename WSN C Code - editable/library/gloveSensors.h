@@ -0,0 +1,153 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Map of the sensors on the glove, shared by the glove, the base station and
+ * the PC tools in the @e Host directory so that they can't drift apart.
+ *
+ * The 16 positions of the sensor mux each select one ADXL345 (through
+ * ACC_EN) and one set of three bend board inputs (through BEND_EN, read on
+ * ADC2, ADC1 and ADC3). @c GLOVESENSORS_MAP() lists the positions in the order
+ * they are sent (see gloveFrame.h), with the name and number printed for each
+ * bend board value. It is used as an X-macro: the caller passes a macro that
+ * is expanded once per position, e.g. to unroll a read sequence:
+ *   @code
+ *     #define READ_ACC(mux, ...)  readAcc(mux, GLOVESENSORS_MUX_BITS(mux));
+ *     GLOVESENSORS_MAP(READ_ACC)
+ *   @endcode
+ * or to build a table of names:
+ *   @code
+ *     static const gloveSensors_labelType labels[16][3] = {
+ *         GLOVESENSORS_MAP(GLOVESENSORS_LABELS)
+ *     };
+ *   @endcode
+ *
+ * The mux address lines A0 to A3 are PC7 to PC4, so a position is selected
+ * with a single write to PORTC (see @c GLOVESENSORS_SET_MUX()).
+ *
+ * @file gloveSensors.h
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+
+#ifndef GLOVESENSORS_H
+#define GLOVESENSORS_H
+
+
+/*------------------------------------------------------------------------------
+ * Sensor map.
+ */
+
+/**
+ * One entry per mux position:
+ * X(mux, ADC2 name, number, ADC1 name, number, ADC3 name, number)
+ **/
+#define GLOVESENSORS_MAP(X) \
+    X( 0, BEND,  0, SPLA,  0, BIAS,  0) \
+    X( 1, BEND,  1, SPLA,  1, BIAS,  1) \
+    X( 2, BEND,  2, SPLA,  2, BIAS,  2) \
+    X( 3, BEND,  3, SPLA,  3, BIAS,  3) \
+    X( 4, BEND,  4, FORC,  0, BIAS,  4) \
+    X( 5, BEND,  5, FORC,  1, BIAS,  5) \
+    X( 6, BEND,  6, FORC,  2, BIAS,  6) \
+    X( 7, BEND,  7, FORC,  3, BIAS,  7) \
+    X( 8, BEND,  8, FORC,  4, BIAS,  8) \
+    X( 9, BEND,  9, FORC,  5, BIAS,  9) \
+    X(10, BEND, 10, FORC,  6, BIAS, 10) \
+    X(11, BEND, 11, FORC,  7, BIAS, 11) \
+    X(12, BEND, 12, FORC,  8, BIAS, 12) \
+    X(13, BEND, 13, FORC,  9, BIAS, 13) \
+    X(14, BEND, 14, FORC, 10, BIAS, 14) \
+    X(15, BEND, 15, FORC, 11, BIAS, 15)
+
+/** Number of mux positions. **/
+#define GLOVESENSORS_POSITIONS      16
+
+/** Name printed for the accelerometers, followed by the mux position. **/
+#define GLOVESENSORS_ACC_NAME       "ACC"
+/** Names of the accelerometer axes, in the order they are sent. **/
+#define GLOVESENSORS_ACC_AXES       "XYZ"
+
+
+/*------------------------------------------------------------------------------
+ * Scales.
+ */
+
+/** Accelerometer readings per g (ADXL345 full resolution). **/
+#define GLOVESENSORS_ACC_LSB_PER_G  256
+
+/** Bend board ADC reference in millivolts. **/
+#define GLOVESENSORS_BEND_REF_MV    3300
+/** Bend board ADC resolution in bits. **/
+#define GLOVESENSORS_BEND_BITS      10
+/** Mask of the valid bits of a bend board reading. **/
+#define GLOVESENSORS_BEND_MASK      ((1 << GLOVESENSORS_BEND_BITS) - 1)
+
+
+/*------------------------------------------------------------------------------
+ * Names.
+ */
+
+/** Space for a name, with its '\0'. **/
+#define GLOVESENSORS_NAME_SIZE      5
+
+/** Name and number printed for one value. **/
+typedef struct {
+    char name[GLOVESENSORS_NAME_SIZE];  /**< Sensor type, e.g. "BEND". **/
+    uint8_t number;                     /**< Sensor of that type. **/
+} gloveSensors_labelType;
+
+/** Use with GLOVESENSORS_MAP() to fill a gloveSensors_labelType[16][3]. **/
+#define GLOVESENSORS_LABELS(mux, name0, number0, name1, number1, name2, number2) \
+        {{#name0, number0}, {#name1, number1}, {#name2, number2}},
+
+
+/*------------------------------------------------------------------------------
+ * Mux.
+ */
+
+/** PORTC bits used by the mux address. **/
+#define GLOVESENSORS_MUX_MASK       0xF0
+
+/** PORTC bits for a mux position (A0 = PC7, A1 = PC6, A2 = PC5, A3 = PC4). **/
+#define GLOVESENSORS_MUX_BITS(mux) \
+        ((((mux) & 0x01) << 7) | (((mux) & 0x02) << 5) | \
+         (((mux) & 0x04) << 3) | (((mux) & 0x08) << 1))
+
+/** Use with GLOVESENSORS_MAP() to fill a table of GLOVESENSORS_MUX_BITS(). **/
+#define GLOVESENSORS_MUX_ENTRY(mux, ...)    GLOVESENSORS_MUX_BITS(mux),
+
+#ifdef UC_AVR
+/** Select a mux position, given its GLOVESENSORS_MUX_BITS(). The other
+ * PORTC pins are kept. **/
+#define GLOVESENSORS_SET_MUX(bits) \
+        (PORTC = (PORTC & ~GLOVESENSORS_MUX_MASK) | (bits))
+#endif
+
+
+#endif
@@ -41,6 +41,10 @@
 #include "rf.h"
 #include "msg.h"
 #include "uart.h"
+#ifdef MSG_TIME_SYNC
+#   include "sampler.h"
+#   include "timeSync.h"
+#endif
 
 
 #ifndef MSG_LEAF_NODE
@@ -59,6 +63,38 @@ static uint16_t getParent(uint16_t address);
 static volatile msgType* msgBuffer;
 static volatile rf_msgType rf_msgBuffer;
 
+#ifdef MSG_TIME_SYNC
+#ifndef RADIO_2420
+#error "MSG_TIME_SYNC needs the SFD timestamps of the CC2420"
+#endif
+
+/* Bytes of data in a beacon: its sequence number, then the global time the
+ * sender's previous beacon was sent and the sequence number of that beacon. */
+#define SYNC_SIZE       6
+
+static timeSync_stateType timeSync;
+
+/* Sequence number of the last beacon sent or used. */
+static uint8_t syncSeq = 0;
+
+/* Global time and sequence number of the last beacon sent, for the next. */
+static uint32_t syncSentTime = 0;
+static uint8_t syncSentSeq = 0;
+
+/* Last beacon received from the parent, and when it arrived (lower 16 bits
+ * of the sampler time). isSyncNew is cleared by msg_updateTimeSync(). */
+static volatile bool isSyncNew = false;
+static volatile uint16_t syncArrival;
+static volatile uint8_t syncNewSeq;
+static volatile uint8_t syncPreviousSeq;
+static volatile uint32_t syncPreviousTime;
+
+/* When the last beacon used arrived, to pair with the time in the next. */
+static bool isSyncArrived = false;
+static uint32_t syncArrived;
+static uint8_t syncArrivedSeq;
+#endif
+
 #ifdef MSG_GATEWAY_NODE
 static volatile uint8_t uartBuffer[MSG_MAX_SIZE + MSG_OVERHEAD_SIZE];
 static uint8_t uartIndex = 0;
@@ -79,6 +115,9 @@ void msg_init(msgType* rxBuffer)
     rf_msgBuffer.data = (volatile uint8_t*)rxBuffer;
     rf_setReceiveBuffer(&rf_msgBuffer);
     rf_setMode(RF_MODE_RECEIVING);
+#ifdef MSG_TIME_SYNC
+    timeSync_init(&timeSync);
+#endif
 }
 
 status_t msg_send(const msgType* txMsg)
@@ -135,11 +174,135 @@ void msg_disableRx(void)
 }
 
 
+#ifdef MSG_TIME_SYNC
+status_t msg_sendTimeSync(void)
+{
+    msgType beacon;
+    uint32_t now;
+    uint16_t sent;
+
+#ifdef MSG_GATEWAY_NODE
+    syncSeq++;
+#else
+    if (!timeSync_isSynced(&timeSync)) {
+        return STATUS_INVALID_ARG;
+    }
+#endif
+
+    beacon.length = SYNC_SIZE;
+    beacon.address = RF_LOCAL_ADDRESS;
+    beacon.type = MSG_TYPE_TIMESYNC;
+    beacon.data[0] = syncSeq;
+    beacon.data[1] = BYTE_0(syncSentTime);
+    beacon.data[2] = BYTE_1(syncSentTime);
+    beacon.data[3] = BYTE_2(syncSentTime);
+    beacon.data[4] = BYTE_3(syncSentTime);
+    beacon.data[5] = syncSentSeq;
+    rf_send(RF_BROADCAST_ADDRESS, (uint8_t const*)&beacon,
+            SYNC_SIZE + MSG_OVERHEAD_SIZE);
+
+    /* The radio timestamped the beacon as it went out, however long it
+     * waited for the channel. The time goes in the next beacon. */
+    if (rf_getTxTime(&sent) != STATUS_OK) {
+        return STATUS_COMM_ERROR;
+    }
+    now = sampler_getTime();
+    syncSentTime = msg_toGlobalTime(now - (uint16_t)((uint16_t)now - sent));
+    syncSentSeq = syncSeq;
+
+    return STATUS_OK;
+}
+
+
+void msg_updateTimeSync(void)
+{
+#ifdef MSG_GATEWAY_NODE
+    /* The gateway's own time is the global time */
+    isSyncNew = false;
+#else
+    uint16_t arrival;
+    uint32_t global;
+    uint32_t now;
+    uint32_t previous;
+    uint8_t seq;
+    uint8_t previousSeq;
+    bool isPair;
+
+    disableInterrupts();
+    if (!isSyncNew) {
+        enableInterrupts();
+        return;
+    }
+    isSyncNew = false;
+    arrival = syncArrival;
+    global = syncPreviousTime;
+    seq = syncNewSeq;
+    previousSeq = syncPreviousSeq;
+    enableInterrupts();
+
+    /* The beacon carries the time the parent sent its previous beacon, which
+     * is paired with when that one arrived here */
+    isPair = isSyncArrived && previousSeq == syncArrivedSeq;
+    previous = syncArrived;
+    now = sampler_getTime();
+    syncArrived = now - (uint16_t)((uint16_t)now - arrival);
+    syncArrivedSeq = seq;
+    isSyncArrived = true;
+    syncSeq = seq;
+    if (!isPair) {
+        return;
+    }
+
+    /* Either clock has jumped (e.g. the parent restarted), or the pair is
+     * wrong. Start again from the next pair rather than from this one. */
+    if (timeSync_add(&timeSync, previous, global) != STATUS_OK) {
+        timeSync_init(&timeSync);
+    }
+#endif
+}
+
+
+bool msg_isTimeSynced(void)
+{
+#ifdef MSG_GATEWAY_NODE
+    return true;
+#else
+    return timeSync_isSynced(&timeSync);
+#endif
+}
+
+
+uint32_t msg_toGlobalTime(uint32_t localTime)
+{
+#ifdef MSG_GATEWAY_NODE
+    return localTime;
+#else
+    return timeSync_toGlobal(&timeSync, localTime);
+#endif
+}
+#endif
+
+
 /*
- * This is signalled every time an RF packet is received. 
+ * This is signalled every time an RF packet is received. Time synchronisation
+ * beacons are kept for msg_updateTimeSync(), and not passed on.
  */
 void rf_callback(volatile rf_msgType* msg)
 {
+#ifdef MSG_TIME_SYNC
+    /* The time only flows down the tree */
+    if (msgBuffer->type == MSG_TYPE_TIMESYNC) {
+        if (msg->srcAddress == RF_PARENT_ADDRESS) {
+            syncArrival = msg->sfdTime;
+            syncNewSeq = msgBuffer->data[0];
+            syncPreviousTime = TO_UINT32(msgBuffer->data[4],
+                    msgBuffer->data[3], msgBuffer->data[2], msgBuffer->data[1]);
+            syncPreviousSeq = msgBuffer->data[5];
+            isSyncNew = true;
+        }
+        return;
+    }
+#endif
         msg_callback(msgBuffer);
 }
 
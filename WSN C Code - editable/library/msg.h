@@ -54,6 +54,14 @@
  * @c UART_DO_NOT_INSERT_RETURN and @c UART_USE_CALLBACK must be defined. The 
  * best place to do that is the application @e makefile.
  *
+ * If @c MSG_TIME_SYNC is defined the nodes share a global time, kept with
+ * @e timeSync.h from beacons sent with @c msg_sendTimeSync(). The gateway's
+ * sampler time (see @e sampler.h) is the global time. Each beacon is
+ * broadcast, and a node that is synchronised sends its own estimate on, so the
+ * time spreads down the tree. A node only uses the beacons of its parent. The
+ * radio timestamps beacons at their start frame delimiter as they are sent and
+ * received (see @c rf_getTxTime()), so this needs the CC2420.
+ *
  * @todo A lot of funtionality can be implemented under this interface:
  *  - Checksum to verify message.
  *  - Packetisation to break up large messages into multiple transmissions.
@@ -89,6 +97,9 @@
 /** Command saying code image is invalid: "<type:8>" **/
 #define MSG_TYPE_REPROG_INVALID     0x02
 
+/** Time synchronisation beacon: "<type:8><seq:8><globalTime:32>" **/
+#define MSG_TYPE_TIMESYNC           0x40
+
 
 /** Address of PC. **/
 #define MSG_UART_ADDRESS            0x0000
@@ -138,6 +149,48 @@ void msg_enableRx(void);
 void msg_disableRx(void);
 
 
+#if defined(MSG_TIME_SYNC) || defined(__DOXYGEN__)
+/**
+ * Broadcast a time synchronisation beacon. A beacon can't carry the time it
+ * is sent, since that is only known once it goes out, so it carries the global
+ * time this node sent its previous beacon, which the children pair with when
+ * that one arrived. The gateway numbers its beacons, and other nodes send on
+ * the number of the last beacon they received.
+ *
+ * @return @c STATUS_OK, @c STATUS_INVALID_ARG if this node is not
+ *     synchronised yet, or @c STATUS_COMM_ERROR if the radio could not send
+ *     the beacon.
+ **/
+status_t msg_sendTimeSync(void);
+
+
+/**
+ * Add the last beacon received to the time synchronisation. Fitting the clock
+ * is too slow for the radio interrupt, so this should be called from the main
+ * loop, within 65ms of the beacon arriving.
+ **/
+void msg_updateTimeSync(void);
+
+
+/**
+ * Check whether the node has received enough beacons to know the global time.
+ *
+ * @return true on the gateway, or once @c timeSync_isSynced() is true.
+ **/
+bool msg_isTimeSynced(void);
+
+
+/**
+ * Turn a local sampler time into global time.
+ *
+ * @param localTime time from @c sampler_getTime().
+ *
+ * @return estimated global time, in the same units.
+ **/
+uint32_t msg_toGlobalTime(uint32_t localTime);
+#endif
+
+
 /**
  * This function should be implemented by the application. It is triggered
  * when a message is received. The application should check if the node's
@@ -92,6 +92,9 @@ static volatile bool isTransmitting;
 /** Recieved bytes will be stored here. **/
 static volatile rf_msgType* rxMsg;
 
+/** If not NULL, received messages are put here instead of in rxMsg. **/
+static rf_queueType* rxQueue;
+
 /** Store current value of channel. **/
 static uint16_t rf_channel;
 
@@ -225,6 +228,12 @@ void rf_send(uint16_t address, const uint8_t* msg, uint8_t length)
 }
 
 
+bool rf_isBusy(void)
+{
+    return isTransmitting;
+}
+
+
 void rf_sendCarrier(void)
 {
     rf_setMode(RF_MODE_STANDBY);
@@ -299,6 +308,14 @@ void rf_setReceiveBuffer(volatile rf_msgType* receiveBuffer)
 }
 
 
+void rf_setReceiveQueue(rf_queueType* queue)
+{
+    disableInterrupts();
+    rxQueue = queue;
+    enableInterrupts();
+}
+
+
 void rf_setChannel(uint16_t channel)
 {
     channel &= 0x01FF;      /* Only 9 bits */
@@ -426,6 +443,9 @@ FORCE_INLINE static void endTransmission(void)
 /** Interrupt triggered when finished transmitting or data is recieved. **/
 ISR(RF_INT_VECTOR)
 {
+    volatile rf_msgType* msg;
+    uint8_t head = 0;
+
     disableInterrupts();
     rf_clearIntFlag();
 #ifdef RF_INTERRUPT_AM  /* revA of 25mm nRF905 board */
@@ -451,19 +471,46 @@ ISR(RF_INT_VECTOR)
      * SPI functions are not used, as it causes a lot of bloat when calling
      * them from within an interrupt.
      */
+    msg = rxMsg;
+    if (rxQueue != NULL) {
+        head = rxQueue->head;
+        msg = &rxQueue->msgs[head];
+        msg->length = RF_MAX_PAYLOAD_SIZE;      /* Constant packet size */
+        if (++head == rxQueue->size) {
+            head = 0;
+        }
+        /* Queue full: the payload must still be read to clear DR */
+        if (head == rxQueue->tail) {
+            rxQueue->overflows++;
+            msg = NULL;
+        }
+    }
+
     spi_enableCsn();
 
     SPI_WRITE_BYTE(R_RX_PAYLOAD);
-    rxMsg->srcAddress = SPI_READ_WRITE_BYTE(0);                 /* Low byte */
-    rxMsg->srcAddress |= (uint16_t)SPI_READ_WRITE_BYTE(0) << 8; /* high byte */
+    if (msg == NULL) {
+        for (uint8_t i = 0; i < RF_MAX_PAYLOAD_SIZE + 2; ++i) {
+            SPI_READ_WRITE_BYTE(0);
+        }
+        spi_disableCsn();
+        enableInterrupts();
+        return;
+    }
+    msg->srcAddress = SPI_READ_WRITE_BYTE(0);                   /* Low byte */
+    msg->srcAddress |= (uint16_t)SPI_READ_WRITE_BYTE(0) << 8;   /* high byte */
     for (uint8_t i = 0; i < RF_MAX_PAYLOAD_SIZE; ++i) {
         /* Read received bytes into memory */
-        rxMsg->data[i] = SPI_READ_WRITE_BYTE(0);
+        msg->data[i] = SPI_READ_WRITE_BYTE(0);
     }
     spi_disableCsn();
 
+    if (rxQueue != NULL) {
+        rxQueue->head = head;
+    }
+
     /* Pass data to application */
-    rf_callback(rxMsg);
+    rf_callback(msg);
 
     enableInterrupts();
 }
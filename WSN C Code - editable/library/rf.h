@@ -88,10 +88,54 @@ typedef struct {
 	uint16_t srcAddress;        /**< Where the message came from. **/
 	uint8_t seqNumber;          /**< Sequence number of message. **/
 	int8_t rssi;                /**< RSSI value in dB (only for CC2420). **/
+    uint16_t sfdTime;           /**< Time of the SFD (only for CC2420). **/
     volatile uint8_t* volatile data;     /**< Payload. **/
 } rf_msgType;
 
 
+/**
+ * Queue that received messages are written into by the radio interrupt, so
+ * that messages arriving while the application handles an earlier one are not
+ * lost. The application provides @c size messages, each with a @c data buffer
+ * of @c RF_MAX_PAYLOAD_SIZE bytes, and reads them with @c rf_queuePeek() and
+ * @c rf_queueRelease(). The queue can hold @c size - 1 messages.
+ **/
+typedef struct {
+    volatile rf_msgType* msgs;  /**< Storage for messages. **/
+    uint8_t size;               /**< Number of entries in @c msgs. **/
+    volatile uint8_t head;      /**< Next entry written by the interrupt. **/
+    volatile uint8_t tail;      /**< Oldest entry, read by the application. **/
+    volatile uint8_t overflows; /**< Messages lost because the queue was full. **/
+} rf_queueType;
+
+
+/**
+ * Counters for messages sent to one node with @c rf_sendAcked() (CC2420 only,
+ * if @c RF_USE_ACK is defined). A rising share of retries shows that a link
+ * is getting worse before messages start to be dropped.
+ **/
+typedef struct {
+    uint16_t address;           /**< Address of the node. **/
+    uint16_t sent;              /**< Messages sent. **/
+    uint16_t acked;             /**< Messages acknowledged. **/
+    uint16_t retried;           /**< Retransmissions. **/
+    uint16_t dropped;           /**< Messages never acknowledged. **/
+} rf_linkStatsType;
+
+
+/**
+ * Counters for clear channel assessments made by CSMA/CA (CC2420 only, if
+ * @c RF_CARRIER_DETECT is defined). A high share of busy assessments means
+ * the channel is crowded, e.g. by other gloves.
+ **/
+typedef struct {
+    uint16_t attempts;          /**< Clear channel assessments. **/
+    uint16_t busy;              /**< Assessments that found the channel busy. **/
+    uint16_t failures;          /**< Messages dropped as the channel stayed
+                                     busy. **/
+} rf_csmaStatsType;
+
+
 /**
  * Initialise the radio, but leave it in sleep mode. See @e rf_nrf9x5.h and
  * @e rf_2420.h for valid values for the parameters.
@@ -105,6 +149,9 @@ void rf_init(uint16_t channel, uint8_t power);
 /**
  * Send a number of bytes using the radio. If a current transmission is taking
  * place, this function will block until the previous transmission is finished.
+ * If @c RF_USE_TX_QUEUE is defined (CC2420 only), the message is queued with
+ * @c rf_sendAsync() instead, and this waits with interrupts enabled until the
+ * queue has been sent. It must then not be called from an interrupt.
  *
  * @param address address to send data to.
  * @param msg pointer to data that will be sent.
@@ -113,6 +160,105 @@ void rf_init(uint16_t channel, uint8_t power);
 void rf_send(uint16_t address, const uint8_t* msg, uint8_t length);
 
 
+/**
+ * Queue a number of bytes to be sent by the radio, and return without waiting
+ * (CC2420 only, if @c RF_USE_TX_QUEUE is defined). Up to @c RF_TX_QUEUE_SIZE
+ * messages are sent in order, each one started from the SFD interrupt at the
+ * end of the one before, so interrupts are only disabled while a message is
+ * written to the radio. @a msg is not copied, and must not be changed until
+ * @c rf_txDone() is called for it.
+ *
+ * @param address address to send data to.
+ * @param msg pointer to data that will be sent.
+ * @param length number of bytes in data to send.
+ * @return @c STATUS_OK if the message was queued, @c STATUS_COMM_ERROR if the
+ *     queue is full, or @c STATUS_INVALID_ARG if @a length is too long or the
+ *     radio is off.
+ **/
+#if (defined(RADIO_2420) && defined(RF_USE_TX_QUEUE)) || defined(__DOXYGEN__)
+status_t rf_sendAsync(uint16_t address, const uint8_t* msg, uint8_t length);
+#endif
+
+
+/**
+ * Send a number of bytes, asking the receiver to acknowledge them, and retry
+ * up to @c RF_ACK_RETRIES times, waiting @c RF_ACK_WAIT_US after each
+ * attempt (CC2420 only, if @c RF_USE_ACK is defined). The receiving radio
+ * acknowledges in hardware if it is receiving and also has @c RF_USE_ACK
+ * defined, and passes a retry of a message it already has to
+ * @c rf_callback() only once. This blocks until the message is acknowledged
+ * or dropped, so it must not be called from an interrupt.
+ *
+ * @param address address to send data to. Broadcasts can't be acknowledged.
+ * @param msg pointer to data that will be sent.
+ * @param length number of bytes in data to send.
+ * @return @c STATUS_ACK, @c STATUS_NO_ACK, or @c STATUS_INVALID_ARG if
+ *     @a length is too long, @a address is @c RF_BROADCAST_ADDRESS, or the
+ *     radio is off.
+ **/
+#if (defined(RADIO_2420) && defined(RF_USE_ACK)) || defined(__DOXYGEN__)
+status_t rf_sendAcked(uint16_t address, const uint8_t* msg, uint8_t length);
+#endif
+
+
+/**
+ * Get the counters for messages sent to a node with @c rf_sendAcked() (CC2420
+ * only, if @c RF_USE_ACK is defined). Up to @c RF_LINK_TABLE_SIZE nodes are
+ * kept.
+ *
+ * @param address address of the node.
+ * @param[out] stats where to store the counters.
+ * @return @c STATUS_OK, or @c STATUS_INVALID_ARG if the node is not known.
+ **/
+#if (defined(RADIO_2420) && defined(RF_USE_ACK)) || defined(__DOXYGEN__)
+status_t rf_getLinkStats(uint16_t address, rf_linkStatsType* stats);
+#endif
+
+
+/**
+ * Get the CSMA/CA counters (CC2420 only, if @c RF_CARRIER_DETECT is
+ * defined). Then each message is sent after a random backoff of up to
+ * 2^BE - 1 periods of 320us, as long as the channel is clear. Each time the
+ * channel is busy, BE is increased from @c RF_CSMA_MIN_BE up to
+ * @c RF_CSMA_MAX_BE and the backoff repeated, and the message is dropped after
+ * @c RF_CSMA_MAX_BACKOFFS retries. The backoffs are timed with Timer3.
+ *
+ * @param[out] stats where to store the counters.
+ **/
+#if (defined(RADIO_2420) && defined(RF_CARRIER_DETECT)) || defined(__DOXYGEN__)
+void rf_getCsmaStats(rf_csmaStatsType* stats);
+#endif
+
+
+/**
+ * Get the time the last message given to @c rf_send() or @c rf_sendAsync()
+ * was sent (CC2420 only). The SFD pin drives the input capture of the
+ * sampler's timer (see @e sampler.h), which is read as the start frame
+ * delimiter goes out. The @c sfdTime of received messages is captured at the
+ * same point of the packet, so the two times of one message on its sender
+ * and its receivers agree to a few microseconds, however long it waited to be
+ * sent. This is how @e timeSync.h beacons are timestamped.
+ *
+ * @param[out] time lower 16 bits of the sampler time at the SFD.
+ * @return @c STATUS_OK, or @c STATUS_COMM_ERROR if the message has not been
+ *     sent (yet).
+ **/
+#if defined(RADIO_2420) || defined(__DOXYGEN__)
+status_t rf_getTxTime(uint16_t* time);
+#endif
+
+
+/**
+ * Check if the radio is still transmitting. @c rf_send() returns once the
+ * packet has been handed to the radio, so this can be used to do other work
+ * instead of blocking in the next @c rf_send().
+ *
+ * @return @c true if a transmission is in progress, or if messages are
+ *     waiting in the queue.
+ **/
+bool rf_isBusy(void);
+
+
 /**
  * Send an unmodulated carrier signal at the current channel and power. This can
  * be useful for RF testing and characterisation.
@@ -129,6 +275,52 @@ void rf_sendCarrier(void);
 void rf_setReceiveBuffer(volatile rf_msgType* receiveBuffer);
 
 
+/**
+ * Store received messages in a queue instead of the single receive buffer.
+ * @c rf_callback() is still called for each message, with its entry in the
+ * queue.
+ *
+ * @param queue where to store messages, or @c NULL to go back to the buffer
+ *     set with @c rf_setReceiveBuffer().
+ **/
+void rf_setReceiveQueue(rf_queueType* queue);
+
+
+/**
+ * Get the oldest message in a receive queue. It stays valid until
+ * @c rf_queueRelease() is called.
+ *
+ * @param queue queue to read from.
+ * @return the oldest message, or @c NULL if the queue is empty.
+ **/
+static inline volatile rf_msgType* rf_queuePeek(rf_queueType* queue)
+{
+    uint8_t tail = queue->tail;
+
+    if (tail == queue->head) {
+        return NULL;
+    }
+    return &queue->msgs[tail];
+}
+
+
+/**
+ * Remove the oldest message from a receive queue, returning its entry to the
+ * radio interrupt.
+ *
+ * @param queue queue to remove the message from. It must not be empty.
+ **/
+static inline void rf_queueRelease(rf_queueType* queue)
+{
+    uint8_t tail = queue->tail;
+
+    if (++tail == queue->size) {
+        tail = 0;
+    }
+    queue->tail = tail;
+}
+
+
 /**
  * Change the mode of the radio. If set to @c RF_MODE_OFF, then rf_init() must
  * be called before using the radio again. @c RF_MODE_SLEEP will use less
@@ -192,4 +384,19 @@ void rf_setUnicastAddress(void);
 void rf_callback(volatile rf_msgType* msg);
 
 
+/**
+ * If RF_USE_TX_QUEUE is defined, then the function below is called, from an
+ * interrupt, when a message queued by @c rf_sendAsync() or @c rf_send() has
+ * been sent, or could not be sent. The application may then reuse @a msg.
+ *
+ * @param msg the data passed to @c rf_sendAsync().
+ * @param status @c STATUS_OK if the message was sent, or
+ *     @c STATUS_COMM_ERROR if the radio did not start sending it (e.g. the
+ *     channel was busy with @c RF_CARRIER_DETECT).
+ **/
+#if (defined(RADIO_2420) && defined(RF_USE_TX_QUEUE)) || defined(__DOXYGEN__)
+void rf_txDone(const uint8_t* msg, status_t status);
+#endif
+
+
 #endif
@@ -0,0 +1,184 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Fixed-rate sampling scheduler. A hardware timer marks the start of each
+ * sampling slot, so the time between sweeps does not depend on how long the
+ * work done in the previous sweep took.
+ *
+ * Typical use:
+ * @code
+ *     sampler_init(100);          // 100 sweeps per second
+ *     for (;;) {
+ *         sampler_wait();         // sleep until the next slot starts
+ *         // read sensors, send data...
+ *     }
+ * @endcode
+ *
+ * If a sweep is still running when its next slot starts, the slot is counted
+ * as an overrun and @c sampler_wait() returns immediately. Slots stay on the
+ * same time grid, so an overrun does not shift the following slots.
+ *
+ * Up to @c SAMPLER_GROUPS groups of sensors can be given their own slot rate,
+ * for example accelerometers at 200Hz and bend sensors at 50Hz:
+ * @code
+ *     sampler_init(200);                  // group 0
+ *     sampler_setGroupRate(1, 50);
+ *     for (;;) {
+ *         groups = sampler_waitGroups();  // groups whose slot has started
+ *         if (groups & BIT(0)) { ... }
+ *         if (groups & BIT(1)) { ... }
+ *     }
+ * @endcode
+ *
+ * On the ATmega128 Timer1 is used (see @e delay_at128.c, which leaves it free
+ * for other modules). It runs continuously at @c SAMPLER_TICKS_PER_SECOND and
+ * its overflow is counted to give a 32-bit time value. Each group uses one of
+ * the compare units (OCR1A, OCR1B, OCR1C).
+ *
+ * @file sampler.h
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+
+/** Frequency of the timer used by the scheduler (F_CPU / 8). With an 8MHz
+ * clock the time is in microseconds. **/
+#define SAMPLER_TICKS_PER_SECOND    (F_CPU / 8)
+
+/** Lowest slot rate (in Hz) that fits in the 16-bit timer compare. **/
+#define SAMPLER_MIN_RATE            (SAMPLER_TICKS_PER_SECOND / 65535UL + 1)
+
+/** Highest slot rate (in Hz) that can be requested. **/
+#define SAMPLER_MAX_RATE            2000
+
+/** Number of groups with independent slot rates. **/
+#define SAMPLER_GROUPS              3
+
+
+/**
+ * Start the scheduler. The first slot starts one period after this is called.
+ * Interrupts are enabled by this function.
+ *
+ * @param rate number of slots per second. Values outside
+ *     @c SAMPLER_MIN_RATE to @c SAMPLER_MAX_RATE are clamped.
+ **/
+void sampler_init(uint16_t rate);
+
+
+/**
+ * Change the slot rate of group 0. This takes effect from the next slot.
+ *
+ * @param rate number of slots per second.
+ **/
+void sampler_setRate(uint16_t rate);
+
+
+/**
+ * Start a group, or change its slot rate. The first slot starts one period
+ * after this is called. sampler_init() must have been called first.
+ *
+ * @param group group number, less than @c SAMPLER_GROUPS.
+ * @param rate number of slots per second, clamped as for sampler_init(). If
+ *     0, the group is stopped.
+ * @return @c STATUS_OK, or @c STATUS_INVALID_ARG if the group does not exist.
+ **/
+status_t sampler_setGroupRate(uint8_t group, uint16_t rate);
+
+
+/**
+ * Start a group, or change its slot period, with its slots on a given time
+ * grid. This is used to line the slots up with an outside event, such as a
+ * radio beacon. The next slot starts at the first time after now that is a
+ * whole number of periods before or after @p start, so the grid can be given
+ * by a time that has already passed.
+ *
+ * @param group group number, less than @c SAMPLER_GROUPS.
+ * @param start time of a slot (see @c sampler_getTime()).
+ * @param ticks ticks between slots. Periods shorter than that of
+ *     @c SAMPLER_MAX_RATE are lengthened.
+ * @return @c STATUS_OK, or @c STATUS_INVALID_ARG if the group does not exist
+ *     or @p ticks is 0.
+ **/
+status_t sampler_alignGroup(uint8_t group, uint32_t start, uint16_t ticks);
+
+
+/** Stop generating slots in all groups. The timer keeps running for
+ * @c sampler_getTime(). **/
+void sampler_stop(void);
+
+
+/**
+ * Wait until the next slot of group 0 starts. The microcontroller is put into
+ * idle sleep mode while waiting. If the slot has already started (the previous
+ * sweep overran) the function returns immediately.
+ **/
+void sampler_wait(void);
+
+
+/**
+ * Wait until the next slot of any group starts, as for sampler_wait().
+ *
+ * @return bit mask of the groups whose slot has started (bit 0 for group 0).
+ **/
+uint8_t sampler_waitGroups(void);
+
+
+/**
+ * Get the number of slots that were missed because a sweep was still running
+ * when the slot after it started.
+ *
+ * @return number of overruns in all groups since @c sampler_init() was
+ *     called.
+ **/
+uint16_t sampler_getOverruns(void);
+
+
+/**
+ * Read the free-running timer used by the scheduler.
+ *
+ * @return time in units of 1 / @c SAMPLER_TICKS_PER_SECOND seconds.
+ **/
+uint32_t sampler_getTime(void);
+
+
+/**
+ * Read the lower 16 bits of the timer. Unlike @c sampler_getTime() this can be
+ * called from an interrupt routine, and is enough to time intervals shorter
+ * than 65536 ticks.
+ *
+ * @return time in units of 1 / @c SAMPLER_TICKS_PER_SECOND seconds, modulo
+ *     65536.
+ **/
+uint16_t sampler_getTimeLow(void);
+
+
+#endif
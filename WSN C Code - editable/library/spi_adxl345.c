@@ -38,7 +38,11 @@
  ******************************************************************************/
   #include "global.h"
 #include "spi_adxl345.h" 
+#include "adxl345.h"
 #include "delay.h"
+#ifdef ADXL345_HW_SPI
+#include "spi.h"
+#endif
 void adxl345_spi_init(void)
 {
 
@@ -146,4 +150,140 @@ uint8_t adxl345_spi_read(uint8_t data)
 	
 	uc_sw_cs_HI;		// disable /uc_sw_cs
 	return data_out;
-}
\ No newline at end of file
+}
+
+void adxl345_spi_readMultiple(uint8_t address, uint8_t* data, uint8_t length)
+{
+#ifdef ADXL345_HW_SPI
+	uint8_t sreg,spcr,spsr;
+
+	// The radio interrupt also uses the SPI, so keep it out until the radio's
+	// settings are restored
+	sreg = SREG;
+	disableInterrupts();
+	spcr = SPCR;
+	spsr = SPSR;
+	SPCR = BIT(SPE) | BIT(MSTR) | BIT(CPOL) | BIT(CPHA);	// SPI mode 3
+	SPSR = BIT(SPI2X);					// F_CPU / 2
+
+	uc_sw_cs_LO;		// enable /uc_sw_cs
+	spi_readWriteByte(address | ADXL345_SPI_READ | ADXL345_SPI_MB);
+	spi_readArray(data, length);
+	uc_sw_cs_HI;		// disable /uc_sw_cs
+
+	SPCR = spcr;
+	SPSR = spsr;
+	SREG = sreg;
+#else
+	uint8_t i,byte;
+
+	uc_sw_SCLK_HI;
+	uc_sw_cs_LO;		// enable /uc_sw_cs
+
+	// Send command, with the read and multiple byte bits set
+	address |= ADXL345_SPI_READ | ADXL345_SPI_MB;
+	for (i=8;i>0;i--)
+	{
+		uc_sw_SCLK_LO;
+		if(address & 0x80) uc_sw_SDI_HI;
+		else uc_sw_SDI_LO;
+		address <<= 1;
+		uc_sw_SCLK_HI;
+	}
+
+	// Read data, the address is incremented after each byte
+	while (length--)
+	{
+		byte = 0;
+		for (i=0;i<8;i++)
+		{
+			uc_sw_SCLK_LO;
+			byte = (byte << 1) | getDOUT();
+			uc_sw_SCLK_HI;
+		}
+		*data++ = byte;
+	}
+	// end of transmission
+
+	uc_sw_cs_HI;		// disable /uc_sw_cs
+#endif
+}
+
+void adxl345_spi_startFifo(uint8_t rate, uint8_t watermark, bool useInt2)
+{
+	uint8_t intMap;
+
+	adxl345_spi_write(REG_ADDR_ADXL345_POWER_CTL, ADXL345_STANDBY_MODE);
+	adxl345_spi_write(REG_ADDR_ADXL345_BW_RATE, rate);
+
+	// Watermark on INT2 if its bit in INT_MAP is set, otherwise on INT1
+	intMap = adxl345_spi_read(REG_ADDR_ADXL345_INT_MAP);
+	if(useInt2) intMap |= ADXL345_INT_WATERMARK;
+	else intMap &= ~ADXL345_INT_WATERMARK;
+	adxl345_spi_write(REG_ADDR_ADXL345_INT_MAP, intMap);
+	adxl345_spi_write(REG_ADDR_ADXL345_INT_ENABLE,
+			adxl345_spi_read(REG_ADDR_ADXL345_INT_ENABLE) | ADXL345_INT_WATERMARK);
+
+	adxl345_spi_write(REG_ADDR_ADXL345_FIFO_CTL,
+			ADXL345_FIFO_STREAM | (watermark & 0x1F));
+	adxl345_spi_write(REG_ADDR_ADXL345_POWER_CTL, ADXL345_MEASURE_MODE);
+}
+
+uint8_t adxl345_spi_fifoEntries(void)
+{
+	return adxl345_spi_read(REG_ADDR_ADXL345_FIFO_STATUS) & 0x3F;
+}
+
+void adxl345_spi_readFifo(uint8_t* data, uint8_t count)
+{
+	while (count--)
+	{
+		// Each read of the data registers pops one sample, which needs 5us
+		// to reach them before the next read
+		adxl345_spi_readMultiple(REG_ADDR_ADXL345_DATA_X0, data, 6);
+		data += 6;
+		delay_us(5);
+	}
+}
+
+void adxl345_spi_setOffsets(const int8_t* offsets)
+{
+	adxl345_spi_write(REG_ADDR_ADXL345_OFSX, offsets[0]);
+	adxl345_spi_write(REG_ADDR_ADXL345_OFSY, offsets[1]);
+	adxl345_spi_write(REG_ADDR_ADXL345_OFSZ, offsets[2]);
+}
+
+void adxl345_spi_calibrateOffsets(int8_t* offsets, uint8_t samples)
+{
+	int32_t sums[3] = {0, 0, 0};
+	int32_t offset;
+	uint8_t data[6];
+	uint8_t n,i;
+
+	offsets[0] = offsets[1] = offsets[2] = 0;
+	adxl345_spi_setOffsets(offsets);
+
+	// Throw away the reading taken before the offsets were cleared
+	adxl345_spi_readMultiple(REG_ADDR_ADXL345_DATA_X0, data, 6);
+	for (n=0;n<samples;n++)
+	{
+		while (!(adxl345_spi_read(REG_ADDR_ADXL345_INT_SOURCE) & ADXL345_INT_DATA_READY));
+		adxl345_spi_readMultiple(REG_ADDR_ADXL345_DATA_X0, data, 6);
+		for (i=0;i<3;i++)
+		sums[i] += (int16_t)TO_UINT16(data[2*i+1], data[2*i]);
+	}
+
+	// At rest X and Y should read 0g and Z +1g
+	sums[2] -= (int32_t)ADXL345_LSB_PER_G * samples;
+	for (i=0;i<3;i++)
+	{
+		// Round to the nearest offset step
+		offset = sums[i] / samples;
+		offset = (offset >= 0) ? (offset + ADXL345_LSB_PER_OFFSET / 2) : (offset - ADXL345_LSB_PER_OFFSET / 2);
+		offset = -offset / ADXL345_LSB_PER_OFFSET;
+		if (offset > INT8_MAX) offset = INT8_MAX;
+		if (offset < INT8_MIN) offset = INT8_MIN;
+		offsets[i] = (int8_t)offset;
+	}
+	adxl345_spi_setOffsets(offsets);
+}
@@ -126,9 +126,113 @@
 #define uc_sw_SDO_OUT  DDRA |= (1<<4)
 #define uc_sw_SDO_IN  DDRA &= ~(1<<4)
 */
+/*
+ * If ADXL345_HW_SPI is defined, adxl345_spi_readMultiple() uses the hardware
+ * SPI (PORTB, shared with the radio) for boards where the accelerometer mux is
+ * connected to the SPI pins. uc_sw_cs is still used as chip select. Otherwise
+ * the pins above are bit-banged.
+ */
+
+/* Flags added to the register address of an SPI transfer. */
+#define ADXL345_SPI_READ    0x80        /* Read instead of write */
+#define ADXL345_SPI_MB      0x40        /* Multiple byte transfer */
+
 void adxl345_spi_init(void);
 void adxl345_spi_write(uint8_t address, uint8_t data);
 uint8_t adxl345_spi_read(uint8_t data);
 char getDOUT(void);
 
+/**
+ * Read consecutive registers in a single transfer, using the multiple byte
+ * bit. The address is incremented by the ADXL345 after each byte, so reading
+ * 6 bytes from DATAX0 (0x32) gets all three axes of one sample.
+ *
+ * @param address first register to read.
+ * @param[out] data where to store the register values.
+ * @param length number of registers to read.
+ **/
+void adxl345_spi_readMultiple(uint8_t address, uint8_t* data, uint8_t length);
+
+/* Output data rates for adxl345_spi_startFifo() (BW_RATE register). Above
+ * 800Hz the datasheet asks for an SPI clock of at least 2MHz, so use
+ * ADXL345_HW_SPI. */
+#define ADXL345_RATE_100HZ      0x0A
+#define ADXL345_RATE_200HZ      0x0B
+#define ADXL345_RATE_400HZ      0x0C
+#define ADXL345_RATE_800HZ      0x0D
+#define ADXL345_RATE_1600HZ     0x0E
+#define ADXL345_RATE_3200HZ     0x0F
+
+/* FIFO_CTL modes */
+#define ADXL345_FIFO_BYPASS     0x00
+#define ADXL345_FIFO_FIFO       0x40
+#define ADXL345_FIFO_STREAM     0x80
+#define ADXL345_FIFO_TRIGGER    0xC0
+
+/* Number of samples held by the FIFO. */
+#define ADXL345_FIFO_SIZE       32
+
+/* Watermark bit in INT_ENABLE, INT_MAP and INT_SOURCE. */
+#define ADXL345_INT_WATERMARK   0x02
+
+/**
+ * Put the selected ADXL345 in FIFO stream mode. It then samples at its own
+ * rate, keeping the newest ADXL345_FIFO_SIZE samples, and the FIFO can be read
+ * in bursts with adxl345_spi_readFifo(). The watermark interrupt is enabled on
+ * the chosen pin, for boards where it is connected; otherwise poll
+ * adxl345_spi_fifoEntries().
+ *
+ * @param rate output data rate (ADXL345_RATE_xxx).
+ * @param watermark number of samples (1 to 31) at which the watermark
+ *     interrupt is raised.
+ * @param useInt2 true to map the watermark interrupt to INT2 instead of INT1.
+ **/
+void adxl345_spi_startFifo(uint8_t rate, uint8_t watermark, bool useInt2);
+
+/**
+ * Get the number of samples waiting in the FIFO of the selected ADXL345.
+ *
+ * @return number of samples (up to ADXL345_FIFO_SIZE).
+ **/
+uint8_t adxl345_spi_fifoEntries(void);
+
+/**
+ * Read samples from the FIFO of the selected ADXL345, oldest first. Each
+ * sample is 6 bytes (X, Y, Z, low byte first), as read from DATAX0.
+ *
+ * @param[out] data where to store the samples (6 bytes each).
+ * @param count number of samples to read. This should not be more than
+ *     adxl345_spi_fifoEntries(), or the last sample is read again.
+ **/
+void adxl345_spi_readFifo(uint8_t* data, uint8_t count);
+
+/* Readings per g in full resolution mode (3.9mg/LSB). */
+#define ADXL345_LSB_PER_G       256
+/* Full resolution readings per OFSX/OFSY/OFSZ step (15.6mg/LSB). */
+#define ADXL345_LSB_PER_OFFSET  4
+
+/* DATA_READY bit in INT_SOURCE. */
+#define ADXL345_INT_DATA_READY  0x80
+
+/**
+ * Write the offset registers (OFSX, OFSY, OFSZ) of the selected ADXL345. The
+ * offsets are added to every reading.
+ *
+ * @param offsets X, Y and Z offsets, in steps of 15.6mg.
+ **/
+void adxl345_spi_setOffsets(const int8_t* offsets);
+
+/**
+ * Work out and write the offsets of the selected ADXL345. It must be at rest
+ * with its Z axis pointing up, and measuring in full resolution mode. The
+ * average of the given number of readings is then made to read 0g on X and Y
+ * and +1g on Z.
+ *
+ * @param[out] offsets X, Y and Z offsets written, to be saved and given to
+ *     adxl345_spi_setOffsets() after a reset.
+ * @param samples number of readings averaged (at most 255, each takes one
+ *     output data period).
+ **/
+void adxl345_spi_calibrateOffsets(int8_t* offsets, uint8_t samples);
+
 #endif
\ No newline at end of file
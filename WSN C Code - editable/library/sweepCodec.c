@@ -0,0 +1,295 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Implementation of the sweep codec. Bits are collected in a 32-bit
+ * accumulator and written out a byte at a time, so no value is handled bit by
+ * bit.
+ *
+ * @file sweepCodec.c
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+#if !defined UC_AVR && !defined UC_8051
+#   include <stdint.h>      /* This file is also used by host tools */
+#endif
+#include "global.h"
+#include "sweepCodec.h"
+
+
+/** Bit writer/reader state. **/
+typedef struct {
+    uint8_t* data;              /* Next byte to write */
+    const uint8_t* next;        /* Next byte to read */
+    uint32_t bits;              /* Bits not yet written/read, lowest bits */
+    uint8_t bitCount;           /* Number of bits held in bits */
+} bitStreamType;
+
+
+/******************************************************************************\
+ * Functions used only within this file.
+\******************************************************************************/
+
+static uint16_t zigzag(int16_t difference);
+static int16_t unzigzag(uint16_t value);
+static uint8_t widthCode(uint16_t mask);
+static uint8_t widthOf(uint8_t code);
+static void putBits(bitStreamType* stream, uint16_t value, uint8_t width);
+static uint16_t getBits(bitStreamType* stream, uint8_t width);
+
+
+/******************************************************************************\
+ * See sweepCodec.h for documentation of these functions.
+\******************************************************************************/
+
+status_t sweepCodec_init(sweepCodec_stateType* codec, uint8_t count,
+        uint8_t keyInterval)
+{
+    if (count == 0 || count > SWEEPCODEC_MAX_VALUES) {
+        return STATUS_INVALID_ARG;
+    }
+
+    codec->count = count;
+    codec->keyInterval = keyInterval;
+    sweepCodec_reset(codec);
+    return STATUS_OK;
+}
+
+
+void sweepCodec_reset(sweepCodec_stateType* codec)
+{
+    codec->hasReference = false;
+    codec->sinceKey = 0;
+}
+
+
+uint8_t sweepCodec_encode(sweepCodec_stateType* codec, const int16_t* values,
+        uint8_t* block)
+{
+    bitStreamType stream;
+    uint8_t* widths;
+    uint8_t groups = SWEEPCODEC_GROUPS(codec->count);
+    uint8_t group, first, last, i, code;
+    uint16_t mask;
+    bool isKeyframe;
+
+    isKeyframe = !codec->hasReference ||
+            (codec->keyInterval != 0 && codec->sinceKey >= codec->keyInterval);
+    if (isKeyframe) {
+        for (i = 0; i < codec->count; ++i) {
+            codec->reference[i] = 0;
+        }
+        codec->sinceKey = 0;
+        codec->hasReference = true;
+    }
+    codec->sinceKey++;
+
+    block[0] = codec->count | (isKeyframe ? SWEEPCODEC_KEYFRAME : 0);
+    widths = &block[1];
+    stream.data = &block[1 + (groups + 1) / 2];
+    stream.bits = 0;
+    stream.bitCount = 0;
+
+    for (group = 0; group < groups; ++group) {
+        first = group * SWEEPCODEC_GROUP_SIZE;
+        last = first + SWEEPCODEC_GROUP_SIZE;
+        if (last > codec->count) {
+            last = codec->count;
+        }
+
+        /* Width needed by the largest value in the group */
+        mask = 0;
+        for (i = first; i < last; ++i) {
+            mask |= zigzag(values[i] - codec->reference[i]);
+        }
+        code = widthCode(mask);
+        if (group & 0x01) {
+            widths[group / 2] |= code;
+        } else {
+            widths[group / 2] = code << 4;
+        }
+
+        for (i = first; i < last; ++i) {
+            putBits(&stream, zigzag(values[i] - codec->reference[i]),
+                    widthOf(code));
+            codec->reference[i] = values[i];
+        }
+    }
+
+    /* Pad the last byte */
+    if (stream.bitCount != 0) {
+        putBits(&stream, 0, 8 - stream.bitCount);
+    }
+    return stream.data - block;
+}
+
+
+status_t sweepCodec_decode(sweepCodec_stateType* codec, const uint8_t* block,
+        uint8_t length, int16_t* values, uint8_t* size)
+{
+    bitStreamType stream;
+    uint8_t groups = SWEEPCODEC_GROUPS(codec->count);
+    uint8_t headerSize = 1 + (groups + 1) / 2;
+    uint16_t bitSize = 0;
+    uint8_t group, first, last, i, width;
+    bool isKeyframe;
+
+    if (length < headerSize ||
+            (block[0] & ~SWEEPCODEC_KEYFRAME) != codec->count) {
+        return STATUS_INVALID_ARG;
+    }
+
+    /* Check the whole block is there before changing anything */
+    for (group = 0; group < groups; ++group) {
+        first = group * SWEEPCODEC_GROUP_SIZE;
+        last = first + SWEEPCODEC_GROUP_SIZE;
+        if (last > codec->count) {
+            last = codec->count;
+        }
+        width = (group & 0x01) ? block[1 + group / 2] : block[1 + group / 2] >> 4;
+        bitSize += (uint16_t)widthOf(width & 0x0F) * (last - first);
+    }
+    if (headerSize + (bitSize + 7) / 8 > length) {
+        return STATUS_INVALID_ARG;
+    }
+    *size = headerSize + (bitSize + 7) / 8;
+
+    isKeyframe = (block[0] & SWEEPCODEC_KEYFRAME) != 0;
+    if (!isKeyframe && !codec->hasReference) {
+        return STATUS_COMM_ERROR;
+    }
+    if (isKeyframe) {
+        for (i = 0; i < codec->count; ++i) {
+            codec->reference[i] = 0;
+        }
+        codec->hasReference = true;
+    }
+
+    stream.next = &block[headerSize];
+    stream.bits = 0;
+    stream.bitCount = 0;
+
+    for (group = 0; group < groups; ++group) {
+        first = group * SWEEPCODEC_GROUP_SIZE;
+        last = first + SWEEPCODEC_GROUP_SIZE;
+        if (last > codec->count) {
+            last = codec->count;
+        }
+        width = (group & 0x01) ? block[1 + group / 2] : block[1 + group / 2] >> 4;
+        width = widthOf(width & 0x0F);
+
+        for (i = first; i < last; ++i) {
+            codec->reference[i] += unzigzag(getBits(&stream, width));
+            values[i] = codec->reference[i];
+        }
+    }
+    return STATUS_OK;
+}
+
+
+/******************************************************************************\
+ * Functions used only within this file.
+\******************************************************************************/
+
+/*------------------------------------------------------------------------------
+ * Map a signed difference to an unsigned value, small magnitudes first.
+ */
+static uint16_t zigzag(int16_t difference)
+{
+    return ((uint16_t)difference << 1) ^ (uint16_t)(difference >> 15);
+}
+
+
+/*------------------------------------------------------------------------------
+ * Undo zigzag().
+ */
+static int16_t unzigzag(uint16_t value)
+{
+    return (int16_t)((value >> 1) ^ -(value & 0x01));
+}
+
+
+/*------------------------------------------------------------------------------
+ * Width code for values whose bits are all in mask.
+ */
+static uint8_t widthCode(uint16_t mask)
+{
+    uint8_t width = 0;
+
+    while (mask != 0) {
+        mask >>= 1;
+        width++;
+    }
+    return (width > SWEEPCODEC_WIDTH_16) ? SWEEPCODEC_WIDTH_16 : width;
+}
+
+
+/*------------------------------------------------------------------------------
+ * Number of bits for a width code.
+ */
+static uint8_t widthOf(uint8_t code)
+{
+    return (code == SWEEPCODEC_WIDTH_16) ? 16 : code;
+}
+
+
+/*------------------------------------------------------------------------------
+ * Append the lowest width bits of value to the stream.
+ */
+static void putBits(bitStreamType* stream, uint16_t value, uint8_t width)
+{
+    if (width == 0) {
+        return;
+    }
+
+    stream->bits = (stream->bits << width) | value;
+    stream->bitCount += width;
+    while (stream->bitCount >= 8) {
+        stream->bitCount -= 8;
+        *stream->data++ = (uint8_t)(stream->bits >> stream->bitCount);
+    }
+}
+
+
+/*------------------------------------------------------------------------------
+ * Take the next width bits from the stream.
+ */
+static uint16_t getBits(bitStreamType* stream, uint8_t width)
+{
+    if (width == 0) {
+        return 0;
+    }
+
+    while (stream->bitCount < width) {
+        stream->bits = (stream->bits << 8) | *stream->next++;
+        stream->bitCount += 8;
+    }
+    stream->bitCount -= width;
+    return (uint16_t)(stream->bits >> stream->bitCount) &
+            (uint16_t)((1UL << width) - 1);
+}
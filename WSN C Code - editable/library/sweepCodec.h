@@ -0,0 +1,158 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Lossless compression of sensor sweeps, for sending several glove sweeps in
+ * one radio payload. This is much lighter than @e slzw.h: it needs one
+ * reference sweep of RAM per stream and works on one sweep at a time.
+ *
+ * Each value is sent as the difference from the same value in the previous
+ * sweep. The differences are zig-zag coded (0, -1, 1, -2, ... become 0, 1, 2,
+ * 3, ...) and packed with the number of bits needed by the largest one in each
+ * group of @c SWEEPCODEC_GROUP_SIZE values. Every @c keyInterval sweeps a
+ * keyframe is sent instead, coded the same way but against zero, so a receiver
+ * that lost a block can start again.
+ *
+ * Block layout:
+ * @verbatim
+       <flags:8><width:4 x groups><value:width x count><padding>
+
+           flags   = SWEEPCODEC_KEYFRAME if the block is a keyframe, ORed with
+                     the number of values in the sweep
+           width   = bits of each value in the group, highest nibble first.
+                     SWEEPCODEC_WIDTH_16 means 16 bits
+           value   = zig-zag coded difference, most significant bit first
+           padding = up to 7 zero bits to end the block on a byte@endverbatim
+ *
+ * A stream needs one @c sweepCodec_stateType on the sender and one on the
+ * receiver. If the receiver misses a block (e.g. a gap in the frame sequence
+ * numbers) it must call @c sweepCodec_reset() and wait for the next keyframe.
+ *
+ * The same file is used on the nodes and by the host tools in the @e Host
+ * directory. On a PC, @e stdint.h must be included before @e global.h.
+ *
+ * @file sweepCodec.h
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+
+#ifndef SWEEPCODEC_H
+#define SWEEPCODEC_H
+
+
+#ifndef SWEEPCODEC_MAX_VALUES
+/** Largest number of values in a sweep (at most 63). **/
+#   define SWEEPCODEC_MAX_VALUES    48
+#endif
+
+/** Number of values that share one bit width. **/
+#define SWEEPCODEC_GROUP_SIZE       8
+
+/** Flag set in the first byte of a keyframe. **/
+#define SWEEPCODEC_KEYFRAME         0x80
+
+/** Width code for 16-bit values (a width of 15 is never used). **/
+#define SWEEPCODEC_WIDTH_16         15
+
+/** Number of width groups for @c n values. **/
+#define SWEEPCODEC_GROUPS(n) \
+        (((n) + SWEEPCODEC_GROUP_SIZE - 1) / SWEEPCODEC_GROUP_SIZE)
+
+/** Largest size in bytes of a block holding @c n values. **/
+#define SWEEPCODEC_MAX_SIZE(n)      (1 + (SWEEPCODEC_GROUPS(n) + 1) / 2 + 2 * (n))
+
+
+/** State of one stream of sweeps, on the sender or the receiver. **/
+typedef struct {
+    int16_t reference[SWEEPCODEC_MAX_VALUES]; /**< Last sweep sent/received. **/
+    uint8_t count;              /**< Values in each sweep. **/
+    uint8_t keyInterval;        /**< Sweeps between keyframes (0 = never). **/
+    uint8_t sinceKey;           /**< Sweeps sent since the last keyframe. **/
+    bool hasReference;          /**< False until a keyframe is sent/received. **/
+} sweepCodec_stateType;
+
+
+/**
+ * Initialise the state of a stream. The first block sent is a keyframe.
+ *
+ * @param codec stream state.
+ * @param count number of values in each sweep (1 to SWEEPCODEC_MAX_VALUES).
+ * @param keyInterval number of sweeps from one keyframe to the next, or 0 to
+ *     only send keyframes after @c sweepCodec_reset(). Only used when encoding.
+ *
+ * @return @c STATUS_OK, or @c STATUS_INVALID_ARG if @a count is out of range.
+ **/
+status_t sweepCodec_init(sweepCodec_stateType* codec, uint8_t count,
+        uint8_t keyInterval);
+
+
+/**
+ * Forget the reference sweep. When encoding, the next block is a keyframe.
+ * When decoding, blocks are rejected until a keyframe is received.
+ *
+ * @param codec stream state.
+ **/
+void sweepCodec_reset(sweepCodec_stateType* codec);
+
+
+/**
+ * Compress one sweep.
+ *
+ * @param codec stream state.
+ * @param values @c count values of the sweep.
+ * @param[out] block where to write the block. This must have space for
+ *     @c SWEEPCODEC_MAX_SIZE(count) bytes.
+ *
+ * @return size of the block in bytes.
+ **/
+uint8_t sweepCodec_encode(sweepCodec_stateType* codec, const int16_t* values,
+        uint8_t* block);
+
+
+/**
+ * Decompress one sweep.
+ *
+ * @param codec stream state.
+ * @param block received block.
+ * @param length number of bytes available at @a block (the block may be
+ *     followed by others).
+ * @param[out] values @c count values of the sweep.
+ * @param[out] size size of the block in bytes, so the next one can be found.
+ *     Only set if @c STATUS_OK is returned.
+ *
+ * @return @c STATUS_OK,
+ *     @c STATUS_INVALID_ARG if the block is too short or does not hold
+ *     @c count values,
+ *     @c STATUS_COMM_ERROR if the block is not a keyframe and no keyframe has
+ *     been received since the last reset. The size is still set in this case.
+ **/
+status_t sweepCodec_decode(sweepCodec_stateType* codec, const uint8_t* block,
+        uint8_t length, int16_t* values, uint8_t* size);
+
+
+#endif
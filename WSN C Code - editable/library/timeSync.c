@@ -0,0 +1,153 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+/***************************************************************************//**
+ * Implementation of FTSP-style time synchronisation. The fit is done around
+ * the newest beacon, so only differences between times are used and the
+ * clocks can wrap.
+ *
+ * @file timeSync.c
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+#if !defined UC_AVR && !defined UC_8051
+#   include <stdint.h>      /* This file is also used by host tools */
+#endif
+#include "global.h"
+#include "timeSync.h"
+
+
+/* Local time differences are divided by this before they are multiplied, so
+ * the sums of products can't overflow for beacons up to a few minutes apart. */
+#define X_SHIFT         8
+
+
+static void fitLine(timeSync_stateType* sync);
+
+
+/******************************************************************************\
+ * See timeSync.h for documentation of these functions.
+\******************************************************************************/
+
+void timeSync_init(timeSync_stateType* sync)
+{
+    sync->count = 0;
+    sync->next = 0;
+    sync->localAverage = 0;
+    sync->offsetAverage = 0;
+    sync->skew = 0;
+}
+
+
+status_t timeSync_add(timeSync_stateType* sync, uint32_t localTime,
+        uint32_t globalTime)
+{
+    status_t status = STATUS_OK;
+    int32_t error;
+
+    if (timeSync_isSynced(sync)) {
+        error = (int32_t)(globalTime - timeSync_toGlobal(sync, localTime));
+        if (error > TIMESYNC_MAX_ERROR || error < -TIMESYNC_MAX_ERROR) {
+            sync->count = 0;
+            sync->next = 0;
+            status = STATUS_INVALID_ARG;
+        }
+    }
+
+    sync->local[sync->next] = localTime;
+    sync->offset[sync->next] = globalTime - localTime;
+    sync->next = (sync->next + 1) % TIMESYNC_TABLE_SIZE;
+    if (sync->count < TIMESYNC_TABLE_SIZE) {
+        sync->count++;
+    }
+    fitLine(sync);
+
+    return status;
+}
+
+
+bool timeSync_isSynced(const timeSync_stateType* sync)
+{
+    return sync->count >= TIMESYNC_MIN_ENTRIES;
+}
+
+
+uint32_t timeSync_toGlobal(const timeSync_stateType* sync, uint32_t localTime)
+{
+    int32_t dx = (int32_t)(localTime - sync->localAverage);
+
+    return localTime + sync->offsetAverage +
+            (int32_t)((int64_t)dx * sync->skew / (1L << TIMESYNC_SKEW_BITS));
+}
+
+
+/******************************************************************************\
+ * Functions used only within this file.
+\******************************************************************************/
+
+/**
+ * Fit the offset against the local time of the beacons in the table by least
+ * squares, and keep the mean of both and the slope.
+ *
+ * @param sync synchronisation state, with at least one beacon.
+ **/
+static void fitLine(timeSync_stateType* sync)
+{
+    uint8_t newest = (sync->next + TIMESYNC_TABLE_SIZE - 1) % TIMESYNC_TABLE_SIZE;
+    uint8_t i;
+    int64_t sumX = 0;
+    int32_t sumY = 0;
+    int32_t meanX, meanY, dx, dy;
+    int64_t sumXX = 0, sumXY = 0;
+
+    /* Sums of the times relative to the newest beacon (the table is only
+     * partly filled until count reaches TIMESYNC_TABLE_SIZE) */
+    for (i = 0; i < sync->count; ++i) {
+        sumX += (int32_t)(sync->local[i] - sync->local[newest]);
+        sumY += (int32_t)(sync->offset[i] - sync->offset[newest]);
+    }
+    meanX = (int32_t)(sumX / sync->count);
+    meanY = sumY / sync->count;
+    sync->localAverage = sync->local[newest] + meanX;
+    sync->offsetAverage = sync->offset[newest] + meanY;
+
+    for (i = 0; i < sync->count; ++i) {
+        dx = ((int32_t)(sync->local[i] - sync->local[newest]) - meanX) /
+                (1L << X_SHIFT);
+        dy = (int32_t)(sync->offset[i] - sync->offset[newest]) - meanY;
+        sumXX += (int64_t)dx * dx;
+        sumXY += (int64_t)dx * dy;
+    }
+
+    /* dy / (dx << X_SHIFT), with TIMESYNC_SKEW_BITS fraction bits */
+    if (sumXX == 0) {
+        sync->skew = 0;
+    } else {
+        sync->skew = (int32_t)(sumXY * (1L << (TIMESYNC_SKEW_BITS - X_SHIFT)) /
+                sumXX);
+    }
+}
@@ -0,0 +1,142 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+/***************************************************************************//**
+ * Network time from timestamped beacons, in the way of the Flooding Time
+ * Synchronisation Protocol (FTSP). A reference node broadcasts its time in
+ * beacons. Each node keeps the last @c TIMESYNC_TABLE_SIZE pairs of its own
+ * time when a beacon arrived and the time in the beacon, and fits a line
+ * through them by least squares. The line gives the offset between the two
+ * clocks and how fast it drifts (the skew), so local times can be turned into
+ * global times between beacons.
+ *
+ * Typical use:
+ * @code
+ *     timeSync_init(&sync);
+ *     ...
+ *     // for each beacon, away from the radio interrupt
+ *     timeSync_add(&sync, localArrival, beaconSent);
+ *     ...
+ *     if (timeSync_isSynced(&sync)) {
+ *         time = timeSync_toGlobal(&sync, sampler_getTime());
+ *     }
+ * @endcode
+ *
+ * Both times should be taken at the same point of the beacon. With the CC2420
+ * that is its start frame delimiter, captured as it is sent and received (see
+ * rf_getTxTime()), so random delays before sending (e.g. CSMA/CA backoffs) do
+ * not matter. The send time is only known once the beacon has gone out, so it
+ * is carried by the next beacon, as in FTSP.
+ *
+ * Times are 32-bit counts that may wrap, such as @c sampler_getTime(). The
+ * skew is kept as a 64-bit fraction, so the fit is slow on an 8-bit
+ * microcontroller (about 1ms) and should not be done in an interrupt routine.
+ *
+ * The same file is used on the nodes and by the host tools in the @e Host
+ * directory. On a PC, @e stdint.h must be included before @e global.h.
+ *
+ * @file timeSync.h
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+
+#ifndef TIMESYNC_H
+#define TIMESYNC_H
+
+
+/** Number of beacons the line is fitted through. **/
+#define TIMESYNC_TABLE_SIZE     8
+/** Beacons needed before the time is taken as synchronised. **/
+#define TIMESYNC_MIN_ENTRIES    3
+/** Largest difference (in ticks) between a beacon and the estimated global
+ * time before the table is cleared, because one of the clocks has jumped. **/
+#define TIMESYNC_MAX_ERROR      1000
+/** Number of fraction bits in the skew. **/
+#define TIMESYNC_SKEW_BITS      24
+
+
+/** State of the synchronisation of one node. **/
+typedef struct {
+    uint32_t local[TIMESYNC_TABLE_SIZE];    /**< Local time of each beacon. **/
+    uint32_t offset[TIMESYNC_TABLE_SIZE];   /**< Global minus local time. **/
+    uint8_t count;              /**< Number of beacons in the table. **/
+    uint8_t next;               /**< Entry replaced by the next beacon. **/
+    uint32_t localAverage;      /**< Mean local time of the beacons. **/
+    uint32_t offsetAverage;     /**< Mean offset of the beacons. **/
+    /** Change of the offset for each local tick, with @c TIMESYNC_SKEW_BITS
+     * fraction bits. **/
+    int32_t skew;
+} timeSync_stateType;
+
+
+/**
+ * Initialise the state, with no beacons.
+ *
+ * @param sync synchronisation state.
+ **/
+void timeSync_init(timeSync_stateType* sync);
+
+
+/**
+ * Add a beacon, replacing the oldest if the table is full, and fit the line
+ * again.
+ *
+ * @param sync synchronisation state.
+ * @param localTime local time when the beacon arrived.
+ * @param globalTime global time at the same moment, from the beacon.
+ *
+ * @return @c STATUS_OK, or @c STATUS_INVALID_ARG if the beacon was more than
+ *     @c TIMESYNC_MAX_ERROR from the estimate, in which case the table was
+ *     cleared and restarted from this beacon.
+ **/
+status_t timeSync_add(timeSync_stateType* sync, uint32_t localTime,
+        uint32_t globalTime);
+
+
+/**
+ * Check whether enough beacons have been received.
+ *
+ * @param sync synchronisation state.
+ *
+ * @return true if there are at least @c TIMESYNC_MIN_ENTRIES beacons.
+ **/
+bool timeSync_isSynced(const timeSync_stateType* sync);
+
+
+/**
+ * Turn a local time into global time. With no beacons the local time is
+ * returned, and with one beacon only the offset is used.
+ *
+ * @param sync synchronisation state.
+ * @param localTime local time.
+ *
+ * @return estimated global time.
+ **/
+uint32_t timeSync_toGlobal(const timeSync_stateType* sync, uint32_t localTime);
+
+
+#endif
@@ -0,0 +1,217 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Implementation of binary UART frames.
+ *
+ * The encoder writes each byte through @c putByte(), which sends it to a buffer
+ * or straight to the UART, and adds it to the CRC. The decoder keeps the bytes
+ * of the frame it is receiving in @c raw, and after a bad CRC it searches the
+ * same bytes for the next sync pattern, so a good frame that started inside
+ * the bad one is not lost.
+ *
+ * @file uartFrame.c
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+#if !defined UC_AVR && !defined UC_8051
+#   include <stdint.h>      /* This file is also used by host tools */
+#endif
+#include <string.h>
+#include "global.h"
+#include "uart.h"
+#include "crc16.h"
+#include "uartFrame.h"
+
+
+#if UARTFRAME_SIZE(UARTFRAME_MAX_SAMPLES) > 255
+#error "UARTFRAME_MAX_SAMPLES is too large"
+#endif
+
+
+/* Where putByte() writes to. If NULL, bytes are sent to the UART. */
+static uint8_t* outPtr;
+
+
+static void putByte(uint8_t data, bool isChecked);
+static void putFrame(uint8_t type, uint8_t seq, uint32_t time,
+        const int16_t* samples, uint8_t count);
+static void discard(uartFrame_decoderType* decoder, uint8_t n);
+
+
+/******************************************************************************\
+ * See uartFrame.h for documentation of these functions.
+\******************************************************************************/
+
+uint8_t uartFrame_encode(uint8_t* buffer, uint8_t type, uint8_t seq,
+        uint32_t time, const int16_t* samples, uint8_t count)
+{
+    outPtr = buffer;
+    putFrame(type, seq, time, samples, count);
+    return outPtr - buffer;
+}
+
+
+#if defined UC_AVR || defined UC_8051
+void uartFrame_send(uint8_t type, uint8_t seq, uint32_t time,
+        const int16_t* samples, uint8_t count)
+{
+    outPtr = NULL;
+    putFrame(type, seq, time, samples, count);
+}
+#endif
+
+
+void uartFrame_decoderInit(uartFrame_decoderType* decoder)
+{
+    decoder->crcErrors = 0;
+    decoder->lostFrames = 0;
+    decoder->isSeqValid = false;
+    decoder->length = 0;
+}
+
+
+bool uartFrame_decode(uartFrame_decoderType* decoder, uint8_t data)
+{
+    uint8_t* raw = decoder->raw;
+    uint8_t count, size, i;
+
+    raw[decoder->length++] = data;
+
+    for (;;) {
+        /* Skip anything before the sync pattern */
+        for (i = 0; i < decoder->length; ++i) {
+            if (raw[i] == UARTFRAME_SYNC_0 &&
+                    (i + 1 == decoder->length || raw[i + 1] == UARTFRAME_SYNC_1)) {
+                break;
+            }
+        }
+        discard(decoder, i);
+
+        if (decoder->length < UARTFRAME_HEADER_SIZE) return false;
+
+        count = raw[UARTFRAME_HEADER_SIZE - 1];
+        if (count > UARTFRAME_MAX_SAMPLES) {
+            discard(decoder, 1);
+            continue;
+        }
+
+        size = UARTFRAME_SIZE(count);
+        if (decoder->length < size) return false;
+
+        crc16_init();
+        for (i = 2; i < size - 2; ++i) {
+            crc16_update(raw[i]);
+        }
+        if (crc16_read() == TO_UINT16(raw[size - 1], raw[size - 2])) break;
+
+        decoder->crcErrors++;
+        discard(decoder, 1);
+    }
+
+    /* Valid frame, so copy out the fields */
+    if (decoder->isSeqValid && raw[3] != decoder->seq) {
+        decoder->lostFrames += (uint8_t)(raw[3] - decoder->seq - 1);
+    }
+    decoder->isSeqValid = true;
+    decoder->type = raw[2];
+    decoder->seq = raw[3];
+    decoder->time = TO_UINT32(raw[7], raw[6], raw[5], raw[4]);
+    decoder->count = count;
+    for (i = 0; i < count; ++i) {
+        decoder->samples[i] = (int16_t)TO_UINT16(
+                raw[UARTFRAME_HEADER_SIZE + 2 * i + 1],
+                raw[UARTFRAME_HEADER_SIZE + 2 * i]);
+    }
+    discard(decoder, size);
+    return true;
+}
+
+
+/******************************************************************************\
+ * Functions used only within this file.
+\******************************************************************************/
+
+/*------------------------------------------------------------------------------
+ * Write a byte of a frame, and add it to the CRC if isChecked is set.
+ */
+static void putByte(uint8_t data, bool isChecked)
+{
+    if (isChecked) crc16_update(data);
+
+    if (outPtr != NULL) {
+        *outPtr++ = data;
+    }
+#if defined UC_AVR || defined UC_8051
+    else {
+        uart_putchar(data);
+    }
+#endif
+}
+
+
+/*------------------------------------------------------------------------------
+ * Write a complete frame with putByte().
+ */
+static void putFrame(uint8_t type, uint8_t seq, uint32_t time,
+        const int16_t* samples, uint8_t count)
+{
+    uint16_t crc;
+
+    if (count > UARTFRAME_MAX_SAMPLES) count = UARTFRAME_MAX_SAMPLES;
+
+    crc16_init();
+    putByte(UARTFRAME_SYNC_0, false);
+    putByte(UARTFRAME_SYNC_1, false);
+    putByte(type, true);
+    putByte(seq, true);
+    putByte(BYTE_0(time), true);
+    putByte(BYTE_1(time), true);
+    putByte(BYTE_2(time), true);
+    putByte(BYTE_3(time), true);
+    putByte(count, true);
+    while (count--) {
+        putByte(LOW_BYTE(*samples), true);
+        putByte(HIGH_BYTE(*samples), true);
+        samples++;
+    }
+    crc = crc16_read();
+    putByte(LOW_BYTE(crc), false);
+    putByte(HIGH_BYTE(crc), false);
+}
+
+
+/*------------------------------------------------------------------------------
+ * Remove the first n bytes from the decoder's buffer.
+ */
+static void discard(uartFrame_decoderType* decoder, uint8_t n)
+{
+    if (n == 0) return;
+    decoder->length -= n;
+    memmove(decoder->raw, decoder->raw + n, decoder->length);
+}
@@ -0,0 +1,163 @@
+/******************************************************************************\
+ * Copyright (c) 2010, Tyndall National Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Tyndall National Institute nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * Binary sensor frames for the UART. Each frame carries a block of raw 16-bit
+ * samples, so the values do not have to be formatted as text on the node.
+ *
+ * Frame layout (multi-byte fields are little endian):
+ * @verbatim
+       <sync:16><type:8><seq:8><time:32><count:8><sample:16 x count><crc:16>
+
+           sync   = UARTFRAME_SYNC_0, UARTFRAME_SYNC_1
+           type   = what the samples are (see UARTFRAME_TYPE_xxx)
+           seq    = sequence number, used to detect lost frames. Frames
+                    holding different parts of the same sweep share it
+           time   = timestamp chosen by the application
+           count  = number of samples (up to UARTFRAME_MAX_SAMPLES)
+           crc    = CRC-16 (see crc16.h) of type to the last sample@endverbatim
+ *
+ * The same file is used on the nodes (to send frames) and by the host tools in
+ * the @e Host directory (to decode them). On a PC, @e stdint.h must be
+ * included before @e global.h.
+ *
+ * Example of decoding a byte stream:
+ *   @code
+ *     uartFrame_decoderType decoder;
+ *     uartFrame_decoderInit(&decoder);
+ *     while ((ch = getc(port)) != EOF) {
+ *         if (uartFrame_decode(&decoder, ch)) {
+ *             // decoder.type, decoder.samples[0 .. decoder.count - 1] ...
+ *         }
+ *     }
+ *   @endcode
+ *
+ * @file uartFrame.h
+ * @date 17-Oct-2026
+ ******************************************************************************/
+
+
+#ifndef UARTFRAME_H
+#define UARTFRAME_H
+
+
+/** First byte of every frame. **/
+#define UARTFRAME_SYNC_0            0xA5
+/** Second byte of every frame. **/
+#define UARTFRAME_SYNC_1            0x5A
+
+/** Frame of accelerometer samples. **/
+#define UARTFRAME_TYPE_ACC          0x01
+/** Frame of bend sensor (ADC) samples. **/
+#define UARTFRAME_TYPE_BEND         0x02
+
+#ifndef UARTFRAME_MAX_SAMPLES
+/** Largest number of samples in one frame. **/
+#define UARTFRAME_MAX_SAMPLES       64
+#endif
+
+/** Number of bytes before the samples (sync, type, seq, time and count). **/
+#define UARTFRAME_HEADER_SIZE       9
+
+/** Size in bytes of a frame carrying @c n samples. **/
+#define UARTFRAME_SIZE(n)           (UARTFRAME_HEADER_SIZE + 2 * (n) + 2)
+
+
+/** State of a frame decoder. The fields after @c time are only valid once
+ * @c uartFrame_decode() returns @c true. **/
+typedef struct {
+    uint8_t type;                               /**< Type of the frame. **/
+    uint8_t seq;                                /**< Sequence number. **/
+    uint32_t time;                              /**< Timestamp. **/
+    uint8_t count;                              /**< Number of samples. **/
+    int16_t samples[UARTFRAME_MAX_SAMPLES];     /**< Decoded samples. **/
+    uint16_t crcErrors;                         /**< Frames with a bad CRC. **/
+    uint16_t lostFrames;                        /**< Skipped @c seq values. **/
+
+    /* Internal state. */
+    bool isSeqValid;
+    uint8_t length;
+    uint8_t raw[UARTFRAME_SIZE(UARTFRAME_MAX_SAMPLES)];
+} uartFrame_decoderType;
+
+
+/**
+ * Write a frame into a buffer.
+ *
+ * @param buffer where to write the frame. This must have space for
+ *     @c UARTFRAME_SIZE(count) bytes.
+ * @param type type of frame.
+ * @param seq sequence number.
+ * @param time timestamp.
+ * @param samples samples to write.
+ * @param count number of samples (limited to @c UARTFRAME_MAX_SAMPLES).
+ *
+ * @return number of bytes written.
+ **/
+uint8_t uartFrame_encode(uint8_t* buffer, uint8_t type, uint8_t seq,
+        uint32_t time, const int16_t* samples, uint8_t count);
+
+
+#if defined UC_AVR || defined UC_8051 || defined(__DOXYGEN__)
+/**
+ * Write a frame directly to the UART, without buffering it. @c uart_init()
+ * must be called first.
+ *
+ * @param type type of frame.
+ * @param seq sequence number.
+ * @param time timestamp.
+ * @param samples samples to write.
+ * @param count number of samples (limited to @c UARTFRAME_MAX_SAMPLES).
+ **/
+void uartFrame_send(uint8_t type, uint8_t seq, uint32_t time,
+        const int16_t* samples, uint8_t count);
+#endif
+
+
+/**
+ * Reset a decoder, e.g. before its first use.
+ *
+ * @param decoder decoder to reset.
+ **/
+void uartFrame_decoderInit(uartFrame_decoderType* decoder);
+
+
+/**
+ * Pass one received byte to a decoder. Bytes that are not part of a frame are
+ * skipped, and the decoder re-synchronises after a corrupted frame.
+ *
+ * @param decoder decoder to use.
+ * @param data received byte.
+ *
+ * @return @c true if @c data completed a frame with a valid CRC, in which case
+ *     the frame fields in @c decoder can be read.
+ **/
+bool uartFrame_decode(uartFrame_decoderType* decoder, uint8_t data);
+
+
+#endif
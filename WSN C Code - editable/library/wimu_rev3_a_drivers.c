@@ -150,4 +150,42 @@ uint8_t adxl345_spi_read(uint8_t data)
 	
 	uc_sw_cs_HI;		// disable /uc_sw_cs
 	return data_out;
-}
\ No newline at end of file
+}
+
+void adxl345_spi_readMultiple(uint8_t address, uint8_t* data, uint8_t length)
+{
+	uint8_t i,j,byte,temp_set,temp_clr;
+
+	temp_set = 1;		// 10
+	temp_clr = 1;		// 10
+
+	uc_sw_SCLK_HI;
+	uc_sw_cs_LO;		// enable /uc_sw_cs
+
+	// Send command, with the read and multiple byte bits set
+	address |= ADXL345_SPI_READ | ADXL345_SPI_MB;
+	for (i=8;i>0;i--)
+	{
+		uc_sw_SCLK_LO; for(j=0;j<temp_clr;j++) delay_us(1);
+		if(address & 0x80) uc_sw_SDI_HI;
+		else uc_sw_SDI_LO;
+		address <<= 1;
+		uc_sw_SCLK_HI; for(j=0;j<temp_set;j++) delay_us(1);
+	}
+
+	// Read data, the address is incremented after each byte
+	while (length--)
+	{
+		byte = 0;
+		for (i=0;i<8;i++)
+		{
+			uc_sw_SCLK_LO; for(j=0;j<temp_clr;j++) delay_us(1);
+			byte = (byte << 1) | getDOUT();
+			uc_sw_SCLK_HI; for(j=0;j<temp_set;j++) delay_us(1);
+		}
+		*data++ = byte;
+	}
+	// end of transmission
+
+	uc_sw_cs_HI;		// disable /uc_sw_cs
+}
@@ -138,9 +138,25 @@
 
 // ADXL345 functions  for WImuRev3_A
 
+/* Flags added to the register address of an SPI transfer. */
+#define ADXL345_SPI_READ    0x80        /* Read instead of write */
+#define ADXL345_SPI_MB      0x40        /* Multiple byte transfer */
+
 void adxl345_spi_init(void);
 void adxl345_spi_write(uint8_t address, uint8_t data);
 uint8_t adxl345_spi_read(uint8_t data);
+
+/**
+ * Read consecutive registers in a single transfer, using the multiple byte
+ * bit. The address is incremented by the ADXL345 after each byte, so reading
+ * 6 bytes from DATAX0 (0x32) gets all three axes of one sample.
+ *
+ * @param address first register to read.
+ * @param[out] data where to store the register values.
+ * @param length number of registers to read.
+ **/
+void adxl345_spi_readMultiple(uint8_t address, uint8_t* data, uint8_t length);
+
 char getDOUT(void);
 
 #endif
\ No newline at end of file